@@ -8,7 +8,6 @@ import argparse
 import subprocess
 import sys
 import os
-import time
 from common import *
 
 #
@@ -180,7 +179,7 @@ if __name__ == "__main__":
 
     print(f"Generating grid... ({args.amount} times)")
 
-    # Generate best grid and clues
+    # grid-gen keeps the grid with most theme words by itself
     grid_file  = grid_file_get(args.name)
     clues_file = clues_file_get(args.name)
 
@@ -188,45 +187,28 @@ if __name__ == "__main__":
     best_clues = None
     best_count = 0
 
-    for iteration in range(1, args.amount + 1):
-        try:
-            print(f"Generating grid #{iteration:02d}...")
-
-            result = subprocess.run([grid_program,
-                                     "--name",   args.name,
-                                     "--length", str(args.length),
-                                     args.model,
-                                    ] + words_arg,
-                                    timeout=args.time)
-
-            # To make next grid generation random, wait 1 more second
-            time.sleep(1)
-
-            if result.returncode != 0:
-                print(f"Failed to generate grid #{iteration:02d}")
-                continue
-
-            if not theme_words:
-                print(f"Generated grid #{iteration:02d}")
-
-                best_grid  = file_read(grid_file)
-                best_clues = file_read(clues_file)
-                break
-
-            # Get amount of words from 'temp.words'
-            curr_count = used_word_amount_get(theme_words)
-
-            if curr_count > best_count:
-                best_grid  = file_read(grid_file)
-                best_clues = file_read(clues_file)
-
-                best_count = curr_count
-
-            print(f"Generated grid #{iteration:02d}: {best_count} theme words")
-    
-        except subprocess.TimeoutExpired:
-            print(f"korsord: Grid generation timed out")
-            continue
+    try:
+        result = subprocess.run([grid_program,
+                                 "--name",   args.name,
+                                 "--length", str(args.length),
+                                 "--amount", str(args.amount),
+                                 "--time",   str(args.time),
+                                 args.model,
+                                ] + words_arg,
+                                timeout=(args.amount * args.time + 60))
+
+        if result.returncode != 0:
+            print(f"Failed to generate grid")
+
+        else:
+            best_grid  = file_read(grid_file)
+            best_clues = file_read(clues_file)
+
+            if theme_words:
+                best_count = used_word_amount_get(theme_words)
+
+    except subprocess.TimeoutExpired:
+        print(f"korsord: Grid generation timed out")
 
     # Store best grid and clues
     if best_grid:
@@ -130,6 +130,12 @@ static inline int dbg_specifier_append(char* buffer, const char* specifier, va_l
 
     return sprintf(buffer, "%lld", arg);
   }
+  else if(strncmp(specifier, "zu", 2) == 0)
+  {
+    size_t arg = va_arg(args, size_t);
+
+    return sprintf(buffer, "%zu", arg);
+  }
   else if(strncmp(specifier, "c", 1) == 0)
   {
     // ‘char’ is promoted to ‘int’ when passed through ‘...’
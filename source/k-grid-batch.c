@@ -0,0 +1,924 @@
+/*
+ * k-grid-batch.c - generate many grids in one process
+ *
+ * A batch manifest has one job per line:
+ *
+ * MODEL NAME SEED WORDS...
+ *
+ * Empty lines and lines starting with # are ignored.
+ * Every word file is only loaded once, and the jobs with the same
+ * word files share one word base between the workers generating the grids
+ *
+ * With a live FIFO, words are added and removed while the grids
+ * are generated. A line of the FIFO is one word:
+ *
+ * +WORD adds the word to the first tier of every word base
+ * -WORD removes the word from every word base
+ *
+ * A job gets the newest words when it starts
+ */
+
+#include "k-grid.h"
+#include "k-grid-intern.h"
+
+#include "k-stats.h"
+
+#include <pthread.h>
+#include <ctype.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/stat.h>
+
+extern int MAX_WORD_LENGTH;
+
+// __builtin_clzll counts the leading zeros, so the bit length is:
+#define CAPACITY(n) (1ULL << (64 - __builtin_clzll(n)))
+
+/*
+ * The max number of workers generating grids at the same time
+ *
+ * 0 means that there is one worker per processor
+ */
+int MAX_BATCH_WORKERS = 0;
+
+/*
+ * The FIFO that words are added and removed through, or NULL
+ */
+char* LIVE_WORDS_FIFO = NULL;
+
+/*
+ * The milliseconds to wait for more live words,
+ * before the changed words are swapped in
+ */
+#define LIVE_POLL_TIMEOUT 100
+
+#define LIVE_BUFFER_SIZE 4096
+
+/*
+ * This struct is only used by these internal functions
+ */
+typedef struct job_t
+{
+  char*        model;
+  char*        name;
+  unsigned int seed;
+  size_t*      wfiles;   // Indexes of the shared word files
+  size_t       wfile_count;
+  size_t       wbase;    // Index of the shared word base
+  bool         is_generating;
+} job_t;
+
+/*
+ * This struct is only used by these internal functions
+ */
+typedef struct batch_t
+{
+  job_t*          jobs;
+  size_t          job_count;
+  char**          wfiles;
+  size_t          wfile_count;
+  wbase_t**       wbases;
+  live_t**        lives;     // NULL without live words
+  size_t          wbase_count;
+  int             amount;
+  size_t          next_job;
+  size_t          fail_count;
+  pthread_mutex_t lock;
+} batch_t;
+
+/*
+ * Get the index of word file, and add it if it is new
+ *
+ * RETURN (int index)
+ * - -1 | Failed to allocate memory
+ */
+static int batch_wfile_index_get(batch_t* batch, char* wfile)
+{
+  for(size_t index = 0; index < batch->wfile_count; index++)
+  {
+    if(strcmp(batch->wfiles[index], wfile) == 0) return index;
+  }
+
+  size_t count = batch->wfile_count;
+
+  if(count == 0 || (count + 1) >= CAPACITY(count))
+  {
+    char** new_wfiles = realloc(batch->wfiles, sizeof(char*) * CAPACITY(count + 1));
+
+    if(!new_wfiles) return -1;
+
+    batch->wfiles = new_wfiles;
+  }
+
+  batch->wfiles[batch->wfile_count++] = strdup(wfile);
+
+  return count;
+}
+
+/*
+ * Parse a manifest line into a job
+ *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | Bad line
+ * - 2 | Failed to allocate memory
+ */
+static int job_parse(job_t* job, batch_t* batch, char* line)
+{
+  *job = (job_t) { 0 };
+
+  char* save = NULL;
+
+  char* model = strtok_r(line, " \t\n", &save);
+  char* name  = strtok_r(NULL, " \t\n", &save);
+  char* seed  = strtok_r(NULL, " \t\n", &save);
+
+  if(!model || !name || !seed) return 1;
+
+  char* seed_end = NULL;
+
+  unsigned long number = strtoul(seed, &seed_end, 10);
+
+  if(*seed_end != '\0') return 1;
+
+  job->seed = number;
+
+  char* wfile;
+
+  while((wfile = strtok_r(NULL, " \t\n", &save)))
+  {
+    int wfile_index = batch_wfile_index_get(batch, wfile);
+
+    if(wfile_index == -1) return 2;
+
+    size_t count = job->wfile_count;
+
+    if(count == 0 || (count + 1) >= CAPACITY(count))
+    {
+      size_t* new_wfiles = realloc(job->wfiles, sizeof(size_t) * CAPACITY(count + 1));
+
+      if(!new_wfiles) return 2;
+
+      job->wfiles = new_wfiles;
+    }
+
+    job->wfiles[job->wfile_count++] = wfile_index;
+  }
+
+  if(job->wfile_count == 0) return 1;
+
+  job->model = strdup(model);
+  job->name  = strdup(name);
+
+  return 0;
+}
+
+/*
+ * Free batch struct
+ */
+static void batch_free(batch_t* batch)
+{
+  for(size_t index = 0; index < batch->job_count; index++)
+  {
+    job_t* job = &batch->jobs[index];
+
+    free(job->model);
+    free(job->name);
+    free(job->wfiles);
+  }
+
+  free(batch->jobs);
+
+  for(size_t index = 0; index < batch->wfile_count; index++)
+  {
+    free(batch->wfiles[index]);
+  }
+
+  free(batch->wfiles);
+
+  for(size_t index = 0; index < batch->wbase_count; index++)
+  {
+    wbase_free(&batch->wbases[index]);
+
+    if(batch->lives) live_free(&batch->lives[index]);
+  }
+
+  free(batch->wbases);
+
+  free(batch->lives);
+}
+
+/*
+ * Load the jobs of manifest
+ *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | Failed to open manifest
+ * - 2 | Bad manifest line
+ * - 3 | Failed to allocate memory
+ */
+static int batch_load(batch_t* batch, char* manifest)
+{
+  FILE* file = fopen(manifest, "r");
+
+  if(!file) return 1;
+
+  char*  line = NULL;
+  size_t size = 0;
+
+  int status = 0;
+
+  for(int number = 1; getline(&line, &size, file) != -1; number++)
+  {
+    char* start = line + strspn(line, " \t\n");
+
+    if(*start == '\0' || *start == '#') continue;
+
+    size_t count = batch->job_count;
+
+    if(count == 0 || (count + 1) >= CAPACITY(count))
+    {
+      job_t* new_jobs = realloc(batch->jobs, sizeof(job_t) * CAPACITY(count + 1));
+
+      if(!new_jobs)
+      {
+        status = 3;
+        break;
+      }
+
+      batch->jobs = new_jobs;
+    }
+
+    job_t* job = &batch->jobs[batch->job_count];
+
+    int parse_status = job_parse(job, batch, start);
+
+    if(parse_status != 0)
+    {
+      error_print("Bad manifest line %d", number);
+
+      free(job->wfiles);
+
+      status = (parse_status == 1) ? 2 : 3;
+      break;
+    }
+
+    batch->job_count++;
+  }
+
+  free(line);
+
+  fclose(file);
+
+  return status;
+}
+
+/*
+ * Get the length of the longest word that fits in the model of job
+ *
+ * If the model fails to load, every word is loaded,
+ * and the job fails when it is run
+ */
+static int job_word_length_get(job_t* job)
+{
+  grid_t* model = model_load(job->model);
+
+  if(!model) return MAX_WORD_LENGTH;
+
+  int max_length = model_word_length_get(model);
+
+  grid_free(&model);
+
+  return max_length;
+}
+
+/*
+ * Get the index of the first job with the same word files as job
+ */
+static size_t job_twin_get(batch_t* batch, size_t job_index)
+{
+  job_t* job = &batch->jobs[job_index];
+
+  for(size_t index = 0; index < job_index; index++)
+  {
+    job_t* twin = &batch->jobs[index];
+
+    if(twin->wfile_count != job->wfile_count) continue;
+
+    if(memcmp(twin->wfiles, job->wfiles, sizeof(size_t) * job->wfile_count) == 0)
+    {
+      return index;
+    }
+  }
+
+  return job_index;
+}
+
+/*
+ * Merge the tries of the word files of job into one trie
+ *
+ * A trie is freed when no more word bases use it. The largest trie
+ * that no later word base uses is taken as the base of the merge,
+ * instead of copying it
+ *
+ * PARAMS
+ * - size_t* uses | The amount of word bases left to use every trie
+ *
+ * RETURN (trie_t* trie)
+ * - NULL | Failed to allocate memory
+ */
+static trie_t* job_trie_merge(job_t* job, trie_t** tries, size_t* uses)
+{
+  // 1. Find the largest trie that is not used after this job
+  int base = -1;
+
+  for(size_t index = 0; index < job->wfile_count; index++)
+  {
+    size_t wfile = job->wfiles[index];
+
+    if(uses[wfile] != 1) continue;
+
+    if(base == -1 || trie_word_count(tries[wfile]) > trie_word_count(tries[job->wfiles[base]]))
+    {
+      base = index;
+    }
+  }
+
+  trie_t* trie = NULL;
+
+  if(base != -1)
+  {
+    trie = tries[job->wfiles[base]];
+
+    tries[job->wfiles[base]] = NULL;
+
+    trie_tier_set(trie, base);
+  }
+  else trie = trie_create();
+
+  if(!trie) return NULL;
+
+  // 2. Merge the words of the other tries
+  int status = 0;
+
+  size_t duplicate_count = 0;
+
+  for(size_t index = 0; index < job->wfile_count; index++)
+  {
+    size_t wfile = job->wfiles[index];
+
+    if(status == 0 && tries[wfile])
+    {
+      status = trie_tier_merge(trie, tries[wfile], index, &duplicate_count);
+    }
+
+    if(--uses[wfile] == 0) trie_free(&tries[wfile]);
+  }
+
+  if(status != 0)
+  {
+    trie_free(&trie);
+
+    return NULL;
+  }
+
+  info_print("Dropped %zu duplicate words: %s", duplicate_count, job->name);
+
+  return trie;
+}
+
+/*
+ * Load every word file of the batch once,
+ * and create one word base for every set of word files
+ *
+ * The words that don't fit in any model of a word base
+ * are not loaded, or are pruned after the words are merged
+ *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | Failed to allocate memory
+ * - 2 | Failed to load word file
+ */
+static int batch_wbases_load(batch_t* batch)
+{
+  batch->wbases = calloc(batch->job_count, sizeof(wbase_t*));
+
+  trie_t** tries = calloc(batch->wfile_count, sizeof(trie_t*));
+
+  size_t* uses = calloc(batch->wfile_count, sizeof(size_t));
+
+  // The longest word of every word base, and of every word file
+  int* wbase_lengths = calloc(batch->job_count, sizeof(int));
+
+  int* wfile_lengths = calloc(batch->wfile_count, sizeof(int));
+
+  if(LIVE_WORDS_FIFO)
+  {
+    batch->lives = calloc(batch->job_count, sizeof(live_t*));
+  }
+
+  if(!batch->wbases || !tries || !uses || !wbase_lengths || !wfile_lengths ||
+     (LIVE_WORDS_FIFO && !batch->lives))
+  {
+    free(wfile_lengths);
+
+    free(wbase_lengths);
+
+    free(uses);
+
+    free(tries);
+
+    return 1;
+  }
+
+  // A word base has the longest words of every model that uses it
+  for(size_t index = 0; index < batch->job_count; index++)
+  {
+    size_t twin_index = job_twin_get(batch, index);
+
+    int max_length = job_word_length_get(&batch->jobs[index]);
+
+    wbase_lengths[twin_index] = MAX(wbase_lengths[twin_index], max_length);
+  }
+
+  // Count the word bases that use every word file
+  for(size_t index = 0; index < batch->job_count; index++)
+  {
+    job_t* job = &batch->jobs[index];
+
+    if(job_twin_get(batch, index) != index) continue;
+
+    for(size_t wfile = 0; wfile < job->wfile_count; wfile++)
+    {
+      uses[job->wfiles[wfile]]++;
+
+      wfile_lengths[job->wfiles[wfile]] = MAX(wfile_lengths[job->wfiles[wfile]], wbase_lengths[index]);
+    }
+  }
+
+  int status = 0;
+
+  // 1. Load the words of every word file at the same time
+  for(size_t index = 0; index < batch->wfile_count; index++)
+  {
+    info_print("Loading words: %s", batch->wfiles[index]);
+  }
+
+  tries_load(tries, batch->wfiles, wfile_lengths, batch->wfile_count);
+
+  for(size_t index = 0; index < batch->wfile_count; index++)
+  {
+    if(!tries[index])
+    {
+      error_print("Failed to load words: %s", batch->wfiles[index]);
+
+      status = 2;
+      break;
+    }
+  }
+
+  // 2. Merge the words of every new set of word files
+  for(size_t index = 0; index < batch->job_count && status == 0; index++)
+  {
+    job_t* job = &batch->jobs[index];
+
+    size_t twin_index = job_twin_get(batch, index);
+
+    if(twin_index != index)
+    {
+      job->wbase = batch->jobs[twin_index].wbase;
+
+      continue;
+    }
+
+    trie_t* trie = job_trie_merge(job, tries, uses);
+
+    // A word file shared with a larger model has words that don't fit
+    for(size_t wfile = 0; wfile < job->wfile_count; wfile++)
+    {
+      if(wfile_lengths[job->wfiles[wfile]] > wbase_lengths[index])
+      {
+        trie_prune(trie, wbase_lengths[index]);
+        break;
+      }
+    }
+
+    // Live words are changed in a copy of the words
+    trie_t* live_trie = batch->lives ? trie_dup(trie) : NULL;
+
+    wbase_t* wbase = wbase_build(trie, job->wfile_count);
+
+    if(batch->lives)
+    {
+      live_t* live = live_create(wbase, live_trie, wbase_lengths[index]);
+
+      if(!live)
+      {
+        status = 1;
+        break;
+      }
+
+      batch->lives[batch->wbase_count] = live;
+    }
+    else if(wbase)
+    {
+      batch->wbases[batch->wbase_count] = wbase;
+    }
+    else
+    {
+      status = 1;
+      break;
+    }
+
+    job->wbase = batch->wbase_count++;
+  }
+
+  for(size_t index = 0; index < batch->wfile_count; index++)
+  {
+    trie_free(&tries[index]);
+  }
+
+  free(tries);
+
+  free(uses);
+
+  free(wbase_lengths);
+
+  free(wfile_lengths);
+
+  return status;
+}
+
+/*
+ * Get the next job that no worker has taken
+ *
+ * RETURN (job_t* job)
+ * - NULL | No jobs are left
+ */
+static job_t* batch_job_take(batch_t* batch)
+{
+  job_t* job = NULL;
+
+  pthread_mutex_lock(&batch->lock);
+
+  if(batch->next_job < batch->job_count && is_generating)
+  {
+    job = &batch->jobs[batch->next_job++];
+  }
+
+  pthread_mutex_unlock(&batch->lock);
+
+  return job;
+}
+
+/*
+ * Generate and export the grid of job
+ *
+ * The word base of the job is shared with the jobs with the same word files
+ *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | Failed to hold live word base
+ * - 2 | Failed to load model
+ * - 3 | Failed to generate grid
+ * - 4 | Failed to export grid
+ */
+static int job_run(batch_t* batch, job_t* job)
+{
+  grid_t* model = model_load(job->model);
+
+  if(!model) return 2;
+
+  wbase_t* wbase;
+
+  if(batch->lives)
+  {
+    wbase = live_wbase_hold(batch->lives[job->wbase]);
+  }
+  else wbase = batch->wbases[job->wbase];
+
+  if(!wbase)
+  {
+    grid_free(&model);
+
+    return 1;
+  }
+
+  rand_seed_set(job->seed);
+
+  grid_t* grid;
+
+  if(batch->amount > 1)
+  {
+    grid = grid_theme_gen(wbase, model, batch->amount);
+  }
+  else
+  {
+    grid = grid_gen(wbase, model);
+  }
+
+  if(batch->lives) live_wbase_release();
+
+  grid_free(&model);
+
+  if(!grid) return 3;
+
+  int status = (grid_export(grid, job->name) == 0) ? 0 : 4;
+
+  grid_free(&grid);
+
+  return status;
+}
+
+/*
+ * Add or remove the word of a live line in every word base
+ */
+static void live_line_apply(batch_t* batch, char* line)
+{
+  bool is_remove = (*line == '-');
+
+  if(*line == '-' || *line == '+') line++;
+
+  for(char* letter = line; *letter; letter++)
+  {
+    *letter = tolower((unsigned char) *letter);
+  }
+
+  if(*line == '\0') return;
+
+  for(size_t index = 0; index < batch->wbase_count; index++)
+  {
+    if(is_remove)
+    {
+      live_word_remove(batch->lives[index], line);
+    }
+    else live_word_add(batch->lives[index], line, 0);
+  }
+
+  info_print("%s live word: %s", is_remove ? "Removed" : "Added", line);
+}
+
+/*
+ * Apply every whole line of buffer
+ *
+ * The rest of the last line is moved to the start of buffer.
+ * A line longer than the buffer is not a word, so it is skipped
+ * until its end, even if the end comes in a later read
+ *
+ * PARAMS
+ * - bool* is_skipping | If the start of buffer is in a skipped line
+ *
+ * RETURN (size_t length)
+ * - The length of the rest of the last line
+ */
+static size_t live_lines_apply(batch_t* batch, char* buffer, size_t length, bool* is_skipping)
+{
+  char* line = buffer;
+
+  char* end;
+
+  while((end = memchr(line, '\n', length - (line - buffer))))
+  {
+    *end = '\0';
+
+    if(end > line && *(end - 1) == '\r') *(end - 1) = '\0';
+
+    if(!(*is_skipping)) live_line_apply(batch, line);
+
+    *is_skipping = false;
+
+    line = end + 1;
+  }
+
+  size_t rest = length - (line - buffer);
+
+  if(*is_skipping || rest >= LIVE_BUFFER_SIZE - 1)
+  {
+    *is_skipping = true;
+
+    return 0;
+  }
+
+  memmove(buffer, line, rest);
+
+  return rest;
+}
+
+/*
+ * Routine that reads live words while the grids are generated
+ *
+ * The words are read until the FIFO is drained,
+ * and then the changed words are swapped in
+ *
+ * PARAMS:
+ * - void* batch | Thread complient pointer to batch
+ */
+static void* live_routine(void* arg)
+{
+  batch_t* batch = arg;
+
+  // The FIFO is opened for writing too, so it never reaches the end
+  // when a writer closes it, and the open doesn't wait for a writer
+  if(mkfifo(LIVE_WORDS_FIFO, 0600) != 0 && errno != EEXIST)
+  {
+    error_print("Failed to create live words: %s", LIVE_WORDS_FIFO);
+
+    return NULL;
+  }
+
+  int fd = open(LIVE_WORDS_FIFO, O_RDWR | O_NONBLOCK);
+
+  if(fd == -1)
+  {
+    error_print("Failed to open live words: %s", LIVE_WORDS_FIFO);
+
+    return NULL;
+  }
+
+  struct pollfd pollfd = { .fd = fd, .events = POLLIN };
+
+  char buffer[LIVE_BUFFER_SIZE];
+
+  size_t length = 0;
+
+  bool is_skipping = false;
+
+  int timeout = LIVE_POLL_TIMEOUT;
+
+  while(is_generating)
+  {
+    if(poll(&pollfd, 1, timeout) > 0)
+    {
+      ssize_t amount = read(fd, buffer + length, sizeof(buffer) - 1 - length);
+
+      if(amount > 0)
+      {
+        length = live_lines_apply(batch, buffer, length + amount, &is_skipping);
+
+        timeout = 0;
+        continue;
+      }
+    }
+
+    // The FIFO is drained, so the changed words are swapped in
+    for(size_t index = 0; index < batch->wbase_count; index++)
+    {
+      if(live_publish(batch->lives[index]) != 0)
+      {
+        error_print("Failed to swap in live words");
+      }
+    }
+
+    timeout = LIVE_POLL_TIMEOUT;
+  }
+
+  close(fd);
+
+  return NULL;
+}
+
+/*
+ * Routine of a batch worker
+ *
+ * PARAMS:
+ * - void* batch | Thread complient pointer to batch
+ */
+static void* batch_routine(void* arg)
+{
+  batch_t* batch = arg;
+
+  gen_track_set(false);
+
+  stats_track_set(false);
+
+  job_t* job;
+
+  while((job = batch_job_take(batch)))
+  {
+    info_print("Generating grid: %s", job->name);
+
+    gen_flag_set(&job->is_generating);
+
+    int status = job_run(batch, job);
+
+    gen_flag_set(NULL);
+
+    if(status != 0)
+    {
+      error_print("Failed to generate grid: %s (%d)", job->name, status);
+
+      pthread_mutex_lock(&batch->lock);
+
+      batch->fail_count++;
+
+      pthread_mutex_unlock(&batch->lock);
+    }
+    else info_print("Generated grid: %s", job->name);
+  }
+
+  return NULL;
+}
+
+/*
+ * Generate the grids of every job in manifest
+ *
+ * The jobs are taken by a pool of workers,
+ * which share the word bases of the word files.
+ * With LIVE_WORDS_FIFO, the words are changed while the grids are generated
+ *
+ * PARAMS
+ * - char* manifest | Path to batch manifest
+ * - int   amount   | Generations to maximize theme words
+ *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | Failed to load manifest
+ * - 2 | Failed to load word files
+ * - 3 | Failed to generate some grids
+ */
+int grid_batch_gen(char* manifest, int amount)
+{
+  batch_t batch = { .amount = amount };
+
+  // 1. Load the jobs and the word files they use
+  if(batch_load(&batch, manifest) != 0)
+  {
+    error_print("Failed to load manifest: %s", manifest);
+
+    batch_free(&batch);
+
+    return 1;
+  }
+
+  if(batch_wbases_load(&batch) != 0)
+  {
+    batch_free(&batch);
+
+    return 2;
+  }
+
+  // 2. Start the workers
+  long worker_count = MAX_BATCH_WORKERS;
+
+  if(worker_count <= 0)
+  {
+    worker_count = sysconf(_SC_NPROCESSORS_ONLN);
+  }
+
+  worker_count = MAX(1, MIN(worker_count, (long) batch.job_count));
+
+  info_print("Generating %zu grids with %ld workers", batch.job_count, worker_count);
+
+  pthread_mutex_init(&batch.lock, NULL);
+
+  is_generating = true;
+
+  pthread_t workers[worker_count];
+
+  long start_count = 0;
+
+  for(; start_count < worker_count; start_count++)
+  {
+    if(pthread_create(&workers[start_count], NULL, batch_routine, &batch) != 0)
+    {
+      error_print("Failed to create batch worker");
+
+      break;
+    }
+  }
+
+  pthread_t live_thread;
+
+  bool is_live = false;
+
+  if(batch.lives)
+  {
+    is_live = (pthread_create(&live_thread, NULL, live_routine, &batch) == 0);
+
+    if(!is_live) error_print("Failed to create live words thread");
+  }
+
+  // Without workers, the main thread has to do the work itself
+  if(start_count == 0) batch_routine(&batch);
+
+  // 3. Wait for the workers to finish
+  for(long index = 0; index < start_count; index++)
+  {
+    pthread_join(workers[index], NULL);
+  }
+
+  is_generating = false;
+
+  if(is_live) pthread_join(live_thread, NULL);
+
+  pthread_mutex_destroy(&batch.lock);
+
+  int status = (batch.fail_count > 0) ? 3 : 0;
+
+  info_print("Generated %zu of %zu grids", batch.job_count - batch.fail_count, batch.job_count);
+
+  batch_free(&batch);
+
+  return status;
+}
@@ -7,10 +7,345 @@
 
 #include <ncurses.h>
 #include <pthread.h>
+#include <signal.h>
+#include <time.h>
 
 pthread_mutex_t best_lock;
 grid_t* best_grid = NULL;
 
+/*
+ * The minimum number of milliseconds between two streamed grids
+ */
+int STREAM_DELAY = 100;
+
+/*
+ * Every strictly improving best grid is written to this stream,
+ * one grid per line, so that other programs can follow the generation
+ *
+ * The records are formatted with best_lock, but written with
+ * stream_lock, so a slow reader never holds up the best grid
+ */
+static FILE*           stream = NULL;
+static pthread_mutex_t stream_lock = PTHREAD_MUTEX_INITIALIZER;
+
+// The number of the last written record, so older records are dropped
+static unsigned long stream_write_number = 0;
+
+static bool stream_is_open = false;
+
+static struct timespec stream_start;
+static struct timespec stream_last;
+
+static unsigned long stream_number = 0;
+
+static int  stream_cross_count = 0;
+static bool stream_is_pending  = false;
+
+/*
+ * The stream thread writes a held back grid when the delay has passed,
+ * even if no better grid comes. It waits on stream_cond with best_lock
+ */
+static pthread_t      stream_thread;
+static pthread_cond_t stream_cond;
+static bool           stream_has_thread = false;
+
+/*
+ * Get the number of milliseconds between two times
+ */
+static long time_diff_get(struct timespec* start, struct timespec* stop)
+{
+  return (stop->tv_sec  - start->tv_sec)  * 1000 +
+         (stop->tv_nsec - start->tv_nsec) / 1000000;
+}
+
+/*
+ * Format best grid as a single line record for the stream
+ *
+ * {"cross_count":42,"elapsed":1.234,"grid":"#b##r###/nit#akja/..."}
+ *
+ * EXPECTS:
+ * - best_lock is locked
+ *
+ * PARAMS
+ * - unsigned long* number | The number of the record, in the order of formatting
+ *
+ * RETURN (char* record)
+ * - NULL | Failed to allocate memory
+ */
+static char* best_grid_stream_format(unsigned long* number, struct timespec* now)
+{
+  long elapsed = time_diff_get(&stream_start, now);
+
+  // The grid has a '/' after every row, and the rest fits in 96 letters
+  size_t size = 96 + best_grid->height * (best_grid->width + 1);
+
+  char* record = malloc(sizeof(char) * size);
+
+  if(!record) return NULL;
+
+  int length = sprintf(record, "{\"cross_count\":%d,\"elapsed\":%ld.%03ld,\"grid\":\"",
+    best_grid->cross_count, elapsed / 1000, elapsed % 1000);
+
+  for(int y = 0; y < best_grid->height; y++)
+  {
+    if(y > 0) record[length++] = '/';
+
+    for(int x = 0; x < best_grid->width; x++)
+    {
+      record[length++] = square_symbol_get(xy_square_get(best_grid, x, y));
+    }
+  }
+
+  strcpy(record + length, "\"}\n");
+
+  *number = ++stream_number;
+
+  stream_cross_count = best_grid->cross_count;
+  stream_last        = *now;
+  stream_is_pending  = false;
+
+  return record;
+}
+
+/*
+ * Write a formatted record to the stream, and free it
+ *
+ * A record that comes after a newer record is dropped,
+ * since the newer record has the better grid
+ *
+ * EXPECTS:
+ * - best_lock is not locked
+ */
+static void stream_record_write(char* record, unsigned long number)
+{
+  if(!record) return;
+
+  pthread_mutex_lock(&stream_lock);
+
+  if(stream && number > stream_write_number)
+  {
+    stream_write_number = number;
+
+    // If the reader is gone, stop streaming
+    if(fputs(record, stream) == EOF || fflush(stream) != 0)
+    {
+      if(stream != stdout) fclose(stream);
+
+      stream = NULL;
+    }
+  }
+
+  pthread_mutex_unlock(&stream_lock);
+
+  free(record);
+}
+
+/*
+ * Format best grid if it is strictly better than the last streamed grid
+ *
+ * Grids that come too close after the last one are held back,
+ * until the delay has passed, the next grid comes or the stream is flushed
+ *
+ * EXPECTS:
+ * - best_lock is locked
+ *
+ * RETURN (char* record)
+ * - NULL | The grid is not streamed now
+ */
+static char* best_grid_stream(unsigned long* number)
+{
+  if(!stream_is_open || !best_grid) return NULL;
+
+  if(best_grid->cross_count <= stream_cross_count) return NULL;
+
+  struct timespec now;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+
+  if(time_diff_get(&stream_last, &now) < STREAM_DELAY)
+  {
+    stream_is_pending = true;
+
+    pthread_cond_signal(&stream_cond);
+
+    return NULL;
+  }
+
+  return best_grid_stream_format(number, &now);
+}
+
+/*
+ * Routine that writes the held back grid when the delay has passed
+ *
+ * The routine stops when the stream is closed
+ */
+static void* stream_routine(void* arg)
+{
+  (void) arg;
+
+  pthread_mutex_lock(&best_lock);
+
+  while(stream_is_open)
+  {
+    if(!stream_is_pending)
+    {
+      pthread_cond_wait(&stream_cond, &best_lock);
+
+      continue;
+    }
+
+    struct timespec due = stream_last;
+
+    due.tv_sec  += STREAM_DELAY / 1000;
+    due.tv_nsec += (STREAM_DELAY % 1000) * 1000000;
+
+    if(due.tv_nsec >= 1000000000)
+    {
+      due.tv_sec  += 1;
+      due.tv_nsec -= 1000000000;
+    }
+
+    pthread_cond_timedwait(&stream_cond, &best_lock, &due);
+
+    // The wait can end early, or the grid can already be written
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    if(stream_is_open && best_grid && stream_is_pending &&
+       time_diff_get(&stream_last, &now) >= STREAM_DELAY)
+    {
+      unsigned long number;
+
+      char* record = best_grid_stream_format(&number, &now);
+
+      pthread_mutex_unlock(&best_lock);
+
+      stream_record_write(record, number);
+
+      pthread_mutex_lock(&best_lock);
+    }
+  }
+
+  pthread_mutex_unlock(&best_lock);
+
+  return NULL;
+}
+
+/*
+ * Start streaming best grids to file
+ *
+ * PARAMS
+ * - char* file | File or FIFO to stream to, or NULL for stdout
+ *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | Failed to open file
+ */
+int best_grid_stream_open(char* file)
+{
+  FILE* file_stream = file ? fopen(file, "w") : stdout;
+
+  if(!file_stream) return 1;
+
+  // A closed reader should not kill the program
+  signal(SIGPIPE, SIG_IGN);
+
+  pthread_mutex_lock(&stream_lock);
+
+  stream = file_stream;
+
+  stream_write_number = 0;
+
+  pthread_mutex_unlock(&stream_lock);
+
+  pthread_mutex_lock(&best_lock);
+
+  clock_gettime(CLOCK_MONOTONIC, &stream_start);
+
+  stream_last = (struct timespec) { 0 };
+
+  stream_cross_count = 0;
+  stream_is_pending  = false;
+
+  stream_is_open = true;
+
+  // The waits of the stream thread are measured like the stream times
+  pthread_condattr_t attr;
+
+  pthread_condattr_init(&attr);
+
+  pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+
+  pthread_cond_init(&stream_cond, &attr);
+
+  pthread_condattr_destroy(&attr);
+
+  stream_has_thread = (pthread_create(&stream_thread, NULL, stream_routine, NULL) == 0);
+
+  pthread_mutex_unlock(&best_lock);
+
+  return 0;
+}
+
+/*
+ * Write the held back best grid to the stream
+ */
+void best_grid_stream_flush(void)
+{
+  pthread_mutex_lock(&best_lock);
+
+  char* record = NULL;
+
+  unsigned long number = 0;
+
+  if(stream_is_open && best_grid && stream_is_pending)
+  {
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    record = best_grid_stream_format(&number, &now);
+  }
+
+  pthread_mutex_unlock(&best_lock);
+
+  stream_record_write(record, number);
+}
+
+/*
+ * Stop streaming best grids
+ */
+void best_grid_stream_close(void)
+{
+  best_grid_stream_flush();
+
+  pthread_mutex_lock(&best_lock);
+
+  stream_is_open = false;
+
+  if(stream_has_thread) pthread_cond_signal(&stream_cond);
+
+  pthread_mutex_unlock(&best_lock);
+
+  if(stream_has_thread)
+  {
+    pthread_join(stream_thread, NULL);
+
+    pthread_cond_destroy(&stream_cond);
+
+    stream_has_thread = false;
+  }
+
+  pthread_mutex_lock(&stream_lock);
+
+  if(stream && stream != stdout) fclose(stream);
+
+  stream = NULL;
+
+  pthread_mutex_unlock(&stream_lock);
+}
+
 /*
  * Get the cross_count of best grid
  *
@@ -36,6 +371,29 @@ int best_grid_cross_count_get(void)
   return cross_count;
 }
 
+/*
+ * Duplicate the best grid
+ *
+ * RETURN (grid_t* dup)
+ * - NULL | No grid has been generated
+ */
+grid_t* best_grid_dup(void)
+{
+  pthread_mutex_lock(&best_lock);
+
+  grid_t* dup = NULL;
+
+  // A cleared best grid has nothing to duplicate
+  if(best_grid && best_grid->cross_count > 0)
+  {
+    dup = grid_dup(best_grid);
+  }
+
+  pthread_mutex_unlock(&best_lock);
+
+  return dup;
+}
+
 /*
  * Set the best grid equal to grid
  *
@@ -58,7 +416,21 @@ void best_grid_set(grid_t* grid)
     best_grid = NULL;
   }
 
+  char* record = NULL;
+
+  unsigned long number = 0;
+
+  // A cleared best grid starts a new generation
+  if(!grid)
+  {
+    stream_cross_count = 0;
+    stream_is_pending  = false;
+  }
+  else record = best_grid_stream(&number);
+
   pthread_mutex_unlock(&best_lock);
+
+  stream_record_write(record, number);
 }
 
 /*
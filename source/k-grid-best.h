@@ -16,6 +16,15 @@ extern void best_grid_set(grid_t* grid);
 
 extern int  best_grid_cross_count_get(void);
 
+extern grid_t* best_grid_dup(void);
+
+
+extern int  best_grid_stream_open(char* file);
+
+extern void best_grid_stream_flush(void);
+
+extern void best_grid_stream_close(void);
+
 
 extern void best_grid_print(void);
 
@@ -18,6 +18,23 @@
 
 #include "k-wbase.h"
 
+/*
+ * Copy length letters of full pattern backwards from stop
+ *
+ * EXPECTS:
+ * - rev_line has room for length + 1 chars
+ * - length is at most stop + 1
+ */
+static void line_reverse(char* rev_line, const char* full_pattern, int stop, int length)
+{
+  for(int index = 0; index < length; index++)
+  {
+    rev_line[index] = full_pattern[stop - index];
+  }
+
+  rev_line[length] = '\0';
+}
+
 /*
  * Check if a word exists vertically, starting at start_y
  *
@@ -25,10 +42,10 @@
  */
 static bool vert_start_word_exists(wbase_t* wbase, grid_t* grid, int x, int start_y)
 {
-  // 1. Create full pattern
-  char full_pattern[grid->height + 1];
+  // 1. Get full pattern
+  const char* full_pattern = vert_full_pattern_get(grid, x);
 
-  if(vert_full_pattern_get(full_pattern, grid, x) != 0)
+  if(!full_pattern)
   {
     return false; // No words exist
   }
@@ -45,40 +62,28 @@ static bool vert_start_word_exists(wbase_t* wbase, grid_t* grid, int x, int star
   }
 
 
-  char pattern[grid->height + 1];
-
-  for(int stop_index = 0; stop_index < stop_count; stop_index++)
-  {
-    int stop_y = stop_ys[stop_index];
-
-    // Don't bother the case where start and stop is cross_y
-    if(start_y == stop_y) continue;
+  bool is_stop[grid->height + 1];
+  memset(is_stop, false, sizeof(bool) * (grid->height + 1));
 
-    int length = (1 + stop_y - start_y);
+  int stop_length = span_stops_get(is_stop, start_y, stop_ys, stop_count);
 
-    // Create current pattern
-    sprintf(pattern, "%.*s", length, full_pattern + start_y);
+  if(stop_length == 0) return false;
 
-    if(wbase_word_exists_for_pattern(wbase, grid->words, pattern))
-    {
-      return true;
-    }
-  }
-
-  return false;
+  // Every stop is checked in one walk from start_y
+  return wbase_span_word_exists(wbase, full_pattern + start_y, is_stop, stop_length);
 }
 
 /*
- * Check if a word exists vertically, starting at start_y
+ * Check if a word exists vertically, stopping at stop_y
  *
  * RETURN (bool does_exist)
  */
 static bool vert_stop_word_exists(wbase_t* wbase, grid_t* grid, int x, int stop_y)
 {
-  // 1. Create full pattern
-  char full_pattern[grid->height + 1];
+  // 1. Get full pattern
+  const char* full_pattern = vert_full_pattern_get(grid, x);
 
-  if(vert_full_pattern_get(full_pattern, grid, x) != 0)
+  if(!full_pattern)
   {
     return false; // No words exist
   }
@@ -95,27 +100,19 @@ static bool vert_stop_word_exists(wbase_t* wbase, grid_t* grid, int x, int stop_
   }
 
 
-  char pattern[grid->height + 1];
-
-  for(int start_index = 0; start_index < start_count; start_index++)
-  {
-    int start_y = start_ys[start_index];
+  bool is_start[grid->height + 1];
+  memset(is_start, false, sizeof(bool) * (grid->height + 1));
 
-    // Don't bother the case where start and stop is cross_y
-    if(start_y == stop_y) continue;
+  int start_length = span_starts_get(is_start, stop_y, start_ys, start_count);
 
-    int length = (1 + stop_y - start_y);
+  if(start_length == 0) return false;
 
-    // Create current pattern
-    sprintf(pattern, "%.*s", length, full_pattern + start_y);
+  // Every start is checked in one walk backwards from stop_y
+  char rev_line[start_length + 1];
 
-    if(wbase_word_exists_for_pattern(wbase, grid->words, pattern))
-    {
-      return true;
-    }
-  }
+  line_reverse(rev_line, full_pattern, stop_y, start_length);
 
-  return false;
+  return wbase_rev_span_word_exists(wbase, rev_line, is_start, start_length);
 }
 
 /*
@@ -125,10 +122,10 @@ static bool vert_stop_word_exists(wbase_t* wbase, grid_t* grid, int x, int stop_
  */
 static int horiz_start_word_exists(wbase_t* wbase, grid_t* grid, int start_x, int y)
 {
-  // 1. Create full pattern
-  char full_pattern[grid->width + 1];
+  // 1. Get full pattern
+  const char* full_pattern = horiz_full_pattern_get(grid, y);
 
-  if(horiz_full_pattern_get(full_pattern, grid, y) != 0)
+  if(!full_pattern)
   {
     return false; // No words exist
   }
@@ -145,26 +142,15 @@ static int horiz_start_word_exists(wbase_t* wbase, grid_t* grid, int start_x, in
   }
 
 
-  char pattern[grid->width + 1];
-
-  for(int stop_index = 0; stop_index < stop_count; stop_index++)
-  {
-    int stop_x = stop_xs[stop_index];
-
-    if(start_x == stop_x) continue;
+  bool is_stop[grid->width + 1];
+  memset(is_stop, false, sizeof(bool) * (grid->width + 1));
 
-    int length = (1 + stop_x - start_x);
+  int stop_length = span_stops_get(is_stop, start_x, stop_xs, stop_count);
 
-    // Create current pattern
-    sprintf(pattern, "%.*s", length, full_pattern + start_x);
+  if(stop_length == 0) return false;
 
-    if(wbase_word_exists_for_pattern(wbase, grid->words, pattern))
-    {
-      return true;
-    }
-  }
-
-  return false;
+  // Every stop is checked in one walk from start_x
+  return wbase_span_word_exists(wbase, full_pattern + start_x, is_stop, stop_length);
 }
 
 /*
@@ -174,10 +160,10 @@ static int horiz_start_word_exists(wbase_t* wbase, grid_t* grid, int start_x, in
  */
 static int horiz_stop_word_exists(wbase_t* wbase, grid_t* grid, int stop_x, int y)
 {
-  // 1. Create full pattern
-  char full_pattern[grid->width + 1];
+  // 1. Get full pattern
+  const char* full_pattern = horiz_full_pattern_get(grid, y);
 
-  if(horiz_full_pattern_get(full_pattern, grid, y) != 0)
+  if(!full_pattern)
   {
     return false; // No words exist
   }
@@ -194,26 +180,19 @@ static int horiz_stop_word_exists(wbase_t* wbase, grid_t* grid, int stop_x, int
   }
 
 
-  char pattern[grid->width + 1];
+  bool is_start[grid->width + 1];
+  memset(is_start, false, sizeof(bool) * (grid->width + 1));
 
-  for(int start_index = 0; start_index < start_count; start_index++)
-  {
-    int start_x = start_xs[start_index];
+  int start_length = span_starts_get(is_start, stop_x, start_xs, start_count);
 
-    if(start_x == stop_x) continue;
+  if(start_length == 0) return false;
 
-    int length = (1 + stop_x - start_x);
+  // Every start is checked in one walk backwards from stop_x
+  char rev_line[start_length + 1];
 
-    // Create current pattern
-    sprintf(pattern, "%.*s", length, full_pattern + start_x);
+  line_reverse(rev_line, full_pattern, stop_x, start_length);
 
-    if(wbase_word_exists_for_pattern(wbase, grid->words, pattern))
-    {
-      return true;
-    }
-  }
-
-  return false;
+  return wbase_rev_span_word_exists(wbase, rev_line, is_start, start_length);
 }
 
 /*
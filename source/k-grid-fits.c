@@ -27,10 +27,10 @@ int MAX_EXIST_AMOUNT = 1000;
  */
 int vert_words_exist(wbase_t* wbase, grid_t* grid, int cross_x, int cross_y)
 {
-  // 1. Create full pattern
-  char full_pattern[grid->height + 1];
+  // 1. Get full pattern
+  const char* full_pattern = vert_full_pattern_get(grid, cross_x);
 
-  if(vert_full_pattern_get(full_pattern, grid, cross_x) != 0)
+  if(!full_pattern)
   {
     return 0; // No words exist
   }
@@ -54,35 +54,28 @@ int vert_words_exist(wbase_t* wbase, grid_t* grid, int cross_x, int cross_y)
   }
 
 
-  char pattern[grid->height + 1];
-
   // The amount of words that exist
   int amount = 0;
 
+  // The spans from the same start are walked together
   for(int start_index = 0; start_index < start_count; start_index++)
   {
     int start_y = start_ys[start_index];
 
-    for(int stop_index = 0; stop_index < stop_count; stop_index++)
-    {
-      int stop_y  = stop_ys[stop_index];
+    bool is_stop[grid->height + 1];
+    memset(is_stop, false, sizeof(bool) * (grid->height + 1));
 
-      // Don't bother the case where start and stop is cross_y
-      if(start_y == stop_y) continue;
+    int stop_length = span_stops_get(is_stop, start_y, stop_ys, stop_count);
 
-      int length = (1 + stop_y - start_y);
+    if(stop_length == 0) continue;
 
-      // Create current pattern
-      sprintf(pattern, "%.*s", length, full_pattern + start_y);
 
+    int max_amount = (MAX_EXIST_AMOUNT - amount);
 
-      int max_amount = (MAX_EXIST_AMOUNT - amount);
+    amount += wbase_span_words_exist(wbase, grid->words, grid->words_hash, full_pattern + start_y, is_stop, stop_length, max_amount);
 
-      amount += wbase_words_exist_for_pattern(wbase, grid->words, pattern, max_amount);
-      
-      // This is opimization only done for performance
-      if(amount >= MAX_EXIST_AMOUNT) break;
-    }
+    // This is opimization only done for performance
+    if(amount >= MAX_EXIST_AMOUNT) break;
   }
 
   return MIN(amount, MAX_EXIST_AMOUNT);
@@ -99,10 +92,10 @@ int vert_words_exist(wbase_t* wbase, grid_t* grid, int cross_x, int cross_y)
  */
 int horiz_words_exist(wbase_t* wbase, grid_t* grid, int cross_x, int cross_y)
 {
-  // 1. Create full pattern
-  char full_pattern[grid->width + 1];
+  // 1. Get full pattern
+  const char* full_pattern = horiz_full_pattern_get(grid, cross_y);
 
-  if(horiz_full_pattern_get(full_pattern, grid, cross_y) != 0)
+  if(!full_pattern)
   {
     return 0; // No words exist
   }
@@ -126,35 +119,28 @@ int horiz_words_exist(wbase_t* wbase, grid_t* grid, int cross_x, int cross_y)
   }
 
 
-  char pattern[grid->width + 1];
-
   // The amount of words that exist
   int amount = 0;
 
+  // The spans from the same start are walked together
   for(int start_index = 0; start_index < start_count; start_index++)
   {
     int start_x = start_xs[start_index];
 
-    for(int stop_index = 0; stop_index < stop_count; stop_index++)
-    {
-      int stop_x  = stop_xs[stop_index];
+    bool is_stop[grid->width + 1];
+    memset(is_stop, false, sizeof(bool) * (grid->width + 1));
 
-      // Don't bother the case where start and stop is cross_x
-      if(start_x == stop_x) continue;
+    int stop_length = span_stops_get(is_stop, start_x, stop_xs, stop_count);
 
-      int length = (1 + stop_x - start_x);
+    if(stop_length == 0) continue;
 
-      // Create current pattern
-      sprintf(pattern, "%.*s", length, full_pattern + start_x);
 
+    int max_amount = (MAX_EXIST_AMOUNT - amount);
 
-      int max_amount = (MAX_EXIST_AMOUNT - amount);
+    amount += wbase_span_words_exist(wbase, grid->words, grid->words_hash, full_pattern + start_x, is_stop, stop_length, max_amount);
 
-      amount += wbase_words_exist_for_pattern(wbase, grid->words, pattern, max_amount);
-      
-      // This is opimization only done for performance
-      if(amount >= MAX_EXIST_AMOUNT) break;
-    }
+    // This is opimization only done for performance
+    if(amount >= MAX_EXIST_AMOUNT) break;
   }
 
   return MIN(amount, MAX_EXIST_AMOUNT);
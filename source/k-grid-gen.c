@@ -10,12 +10,196 @@
 
 #include "k-stats.h"
 
+#include <time.h>
+
 bool is_generating = false;
 
-#define GEN_DONE 0
-#define GEN_FAIL 1
-#define GEN_STOP 2
-#define GEN_HALF 3
+/*
+ * The max number of seconds a single generation can take
+ *
+ * 0 means that there is no time limit
+ */
+int MAX_GEN_TIME = 0;
+
+/*
+ * The max number of seconds of every generation that maximizes theme words
+ *
+ * Otherwise a single generation without a solution
+ * would keep the other generations from ever running
+ */
+int THEME_GEN_TIME = 10;
+
+/*
+ * The max number of seconds of all generations that maximize
+ * theme words together, when MAX_GEN_TIME is 0
+ */
+int THEME_TIME = 60;
+
+/*
+ * The time when the current generation has to stop
+ *
+ * 0 means that the current generation has no time limit
+ */
+static __thread time_t gen_deadline = 0;
+
+/*
+ * The score of the best grid, when optimizing theme words
+ *
+ * Branches that can't beat this score are abandoned
+ *
+ * -1 means that there is no score to beat
+ */
+static __thread int best_score = -1;
+
+/*
+ * The highest score a single word can give
+ */
+static __thread int max_word_score = 0;
+
+/*
+ * If the generation is shown in the current grid, best grid and stats
+ *
+ * Batch workers generate many grids at the same time,
+ * and would only fight over the shared grids
+ */
+static __thread bool gen_is_tracked = true;
+
+/*
+ * The flag that the generation of this thread runs while set
+ *
+ * Batch workers have one flag per job, so that a job starting
+ * or stopping doesn't change the other jobs
+ */
+static __thread bool* gen_flag = &is_generating;
+
+/*
+ * The random seed of this thread
+ *
+ * Threads without a seed share the sequence of rand()
+ */
+static __thread unsigned int rand_seed = 0;
+static __thread bool rand_is_seeded = false;
+
+/*
+ * Seed the random numbers of the calling thread,
+ * so that the same seed always generates the same grid
+ */
+void rand_seed_set(unsigned int seed)
+{
+  rand_seed = seed;
+
+  rand_is_seeded = true;
+}
+
+/*
+ * Get a random number from the sequence of the calling thread
+ *
+ * RETURN (int number)
+ * - min | 0
+ * - max | RAND_MAX
+ */
+int rand_get(void)
+{
+  return rand_is_seeded ? rand_r(&rand_seed) : rand();
+}
+
+/*
+ * Set if the generation of the calling thread should be tracked
+ */
+void gen_track_set(bool is_tracked)
+{
+  gen_is_tracked = is_tracked;
+}
+
+/*
+ * Set the flag of the generation of the calling thread
+ *
+ * NULL gives the thread the shared is_generating flag
+ */
+void gen_flag_set(bool* is_running)
+{
+  gen_flag = is_running ? is_running : &is_generating;
+}
+
+/*
+ * Set the time when the generation of the calling thread has to stop
+ *
+ * PARAMS
+ * - time_t deadline | 0 means that there is no time limit
+ */
+void gen_deadline_set(time_t deadline)
+{
+  gen_deadline = deadline;
+}
+
+/*
+ * Check if the generation was stopped, either by its own flag
+ * or by is_generating, which stops every generation
+ *
+ * RETURN (bool is_stopped)
+ */
+static bool gen_is_stopped(void)
+{
+  return !(*gen_flag) || !is_generating;
+}
+
+/*
+ * Check if the generation should continue
+ *
+ * RETURN (bool is_running)
+ */
+static bool gen_is_running(void)
+{
+  if(gen_is_stopped()) return false;
+
+  return (gen_deadline == 0 || time(NULL) < gen_deadline);
+}
+
+/*
+ * Count the unfilled directions of every square, see grid_t
+ */
+static void grid_open_count_reset(grid_t* grid)
+{
+  grid->open_count = 0;
+
+  for(int x = 0; x < grid->width; x++)
+  {
+    for(int y = 0; y < grid->height; y++)
+    {
+      grid->open_count += square_open_count_get(xy_square_get(grid, x, y));
+    }
+  }
+}
+
+/*
+ * Check if the grid still can beat the best score
+ *
+ * Every unfilled direction of a square is an open slot.
+ * A new word fills at least two open slots, so the number
+ * of words that still fit is at most half of the open slots
+ *
+ * RETURN (bool can_beat)
+ */
+static bool grid_can_beat_best_score(grid_t* grid)
+{
+  if(best_score == -1) return true;
+
+  int max_score = grid->score + (grid->open_count / 2) * max_word_score;
+
+  return (max_score > best_score);
+}
+
+/*
+ * Get the score of a word that is about to be placed
+ *
+ * The score is looked up once, and given to the functions
+ * that insert and remove the word. With only one tier,
+ * every word has the score 0
+ */
+static int word_score_get(wbase_t* wbase, const char* word)
+{
+  return (wbase->count > 1) ? wbase_word_score_get(wbase, word) : 0;
+}
 
 /*
  * If either vert_word_gen or horiz_word_gen
@@ -90,10 +274,10 @@ static int horiz_word_embed(wbase_t* wbase, grid_t* grid, const char* word, int
 /*
  *
  */
-static int horiz_word_test(wbase_t* wbase, grid_t* grid, const char* word, int x, int y)
+static int horiz_word_test(wbase_t* wbase, grid_t* grid, const char* word, int score, int x, int y)
 {
   // 1. Insert the word in the grid
-  int insert_status = horiz_word_insert(wbase, grid, word, x, y);
+  int insert_status = horiz_word_insert(grid, word, score, x, y);
 
   if(insert_status == INSERT_PERFECT)
   {
@@ -130,7 +314,7 @@ static int horiz_word_test(wbase_t* wbase, grid_t* grid, const char* word, int x
   {
     // remove all non is_crossed letters in current horizontal word
     // and try re-generating with new partial success
-    horiz_word_remove(grid, word, x, y);
+    horiz_word_remove(grid, word, score, x, y);
 
     return horiz_word_gen(wbase, grid, x, y);
   }
@@ -145,7 +329,7 @@ static int horiz_words_test(wbase_t* wbase, grid_t* grid, gword_t* gwords, size_
 {
   for(size_t index = 0; index < word_count; index++)
   {
-    if(!is_generating) return GEN_STOP;
+    if(!gen_is_running()) return GEN_STOP;
 
     gword_t gword = gwords[index];
 
@@ -154,7 +338,9 @@ static int horiz_words_test(wbase_t* wbase, grid_t* grid, gword_t* gwords, size_
 
     grid_t* test_grid = grid_dup(grid);
 
-    int test_status = horiz_word_test(wbase, test_grid, word, start_x, y);
+    int score = word_score_get(wbase, word);
+
+    int test_status = horiz_word_test(wbase, test_grid, word, score, start_x, y);
 
     if(test_status == GEN_DONE)
     {
@@ -181,11 +367,14 @@ static int horiz_words_test(wbase_t* wbase, grid_t* grid, gword_t* gwords, size_
  */
 static int horiz_word_gen(wbase_t* wbase, grid_t* grid, int cross_x, int cross_y)
 {
-  if(!is_generating) return GEN_STOP;
+  if(!gen_is_running()) return GEN_STOP;
 
   stats_test_incr();
 
-  curr_grid_set(grid);
+  // This branch can't give a better grid than the best one
+  if(!grid_can_beat_best_score(grid)) return GEN_FAIL;
+
+  if(gen_is_tracked) curr_grid_set(grid);
 
   // curr_grid_print();
   // usleep(1000000);
@@ -193,10 +382,10 @@ static int horiz_word_gen(wbase_t* wbase, grid_t* grid, int cross_x, int cross_y
 
   square_t* square = xy_square_get(grid, cross_x, cross_y);
 
-  if(!square || square->type == SQUARE_BLOCK) return GEN_FAIL;
+  if(!square || square_type_get(square) == SQUARE_BLOCK) return GEN_FAIL;
 
 
-  if(grid->cross_count > best_grid_cross_count_get())
+  if(gen_is_tracked && grid->cross_count > best_grid_cross_count_get())
   {
     // info_print("new best grid: %d", grid->cross_count);
     best_grid_set(grid);
@@ -281,10 +470,10 @@ static int vert_word_embed(wbase_t* wbase, grid_t* grid, const char* word, int x
 /*
  *
  */
-static int vert_word_test(wbase_t* wbase, grid_t* grid, const char* word, int x, int y)
+static int vert_word_test(wbase_t* wbase, grid_t* grid, const char* word, int score, int x, int y)
 {
   // 1. Insert the word in the grid
-  int insert_status = vert_word_insert(wbase, grid, word, x, y);
+  int insert_status = vert_word_insert(grid, word, score, x, y);
 
   if(insert_status == INSERT_PERFECT)
   {
@@ -321,7 +510,7 @@ static int vert_word_test(wbase_t* wbase, grid_t* grid, const char* word, int x,
   {
     // remove all non is_crossed letters in current vertical word
     // and try re-generating with new partial success
-    vert_word_remove(grid, word, x, y);
+    vert_word_remove(grid, word, score, x, y);
 
     return vert_word_gen(wbase, grid, x, y);
   }
@@ -336,7 +525,7 @@ static int vert_words_test(wbase_t* wbase, grid_t* grid, gword_t* gwords, size_t
 {
   for(size_t index = 0; index < word_count; index++)
   {
-    if(!is_generating) return GEN_STOP;
+    if(!gen_is_running()) return GEN_STOP;
 
     gword_t gword = gwords[index];
 
@@ -345,7 +534,9 @@ static int vert_words_test(wbase_t* wbase, grid_t* grid, gword_t* gwords, size_t
 
     grid_t* test_grid = grid_dup(grid);
 
-    int test_status = vert_word_test(wbase, test_grid, word, x, start_y);
+    int score = word_score_get(wbase, word);
+
+    int test_status = vert_word_test(wbase, test_grid, word, score, x, start_y);
 
     if(test_status == GEN_DONE)
     {
@@ -372,21 +563,24 @@ static int vert_words_test(wbase_t* wbase, grid_t* grid, gword_t* gwords, size_t
  */
 static int vert_word_gen(wbase_t* wbase, grid_t* grid, int cross_x, int cross_y)
 {
-  if(!is_generating) return GEN_STOP;
+  if(!gen_is_running()) return GEN_STOP;
 
   stats_test_incr();
 
-  curr_grid_set(grid);
+  // This branch can't give a better grid than the best one
+  if(!grid_can_beat_best_score(grid)) return GEN_FAIL;
+
+  if(gen_is_tracked) curr_grid_set(grid);
   // curr_grid_print();
   // usleep(1000000);
 
 
   square_t* square = xy_square_get(grid, cross_x, cross_y);
 
-  if(!square || square->type == SQUARE_BLOCK) return GEN_FAIL;
+  if(!square || square_type_get(square) == SQUARE_BLOCK) return GEN_FAIL;
 
 
-  if(grid->cross_count > best_grid_cross_count_get())
+  if(gen_is_tracked && grid->cross_count > best_grid_cross_count_get())
   {
     // info_print("new best grid: %d", grid->cross_count);
     best_grid_set(grid);
@@ -423,9 +617,45 @@ static int vert_word_gen(wbase_t* wbase, grid_t* grid, int cross_x, int cross_y)
 }
 
 /*
- * Generate crossword grid
+ * Generate words in every unfilled square inside an area of the grid
+ *
+ * Squares outside of the area are not visited,
+ * but words generated inside it may still reach outside
+ *
+ * RETURN (int status)
+ * - GEN_DONE | Every square in the area is filled
+ * - GEN_FAIL | A square could not be filled
+ * - GEN_STOP | The generation was stopped
  */
-grid_t* grid_gen(wbase_t* wbase, grid_t* model)
+int grid_area_gen(wbase_t* wbase, grid_t* grid, int start_x, int start_y, int stop_x, int stop_y)
+{
+  grid_open_count_reset(grid);
+
+  for(int x = start_x; (x <= stop_x) && gen_is_running(); x++)
+  {
+    for(int y = start_y; (y <= stop_y) && gen_is_running(); y++)
+    {
+      if(xy_square_is_done(grid, x, y)) continue;
+        
+      int gen_status = vert_word_gen(wbase, grid, x, y);
+
+      if (gen_status == GEN_STOP || gen_status == GEN_FAIL)
+      {
+        return gen_status;
+      }
+    }
+  }
+
+  return gen_is_running() ? GEN_DONE : GEN_STOP;
+}
+
+/*
+ * Generate crossword grid in at most gen_time seconds
+ *
+ * PARAMS
+ * - int gen_time | 0 means that there is no time limit
+ */
+static grid_t* grid_timed_gen(wbase_t* wbase, grid_t* model, int gen_time)
 {
   grid_t* grid = grid_dup(model);
 
@@ -434,26 +664,95 @@ grid_t* grid_gen(wbase_t* wbase, grid_t* model)
   // 2. Prepare the grid for generation
   grid_prep(grid);
 
-  is_generating = true;
+  *gen_flag = true;
+
+  gen_deadline = (gen_time > 0) ? time(NULL) + gen_time : 0;
+
+  int gen_status = grid_area_gen(wbase, grid, 0, 0, grid->width - 1, grid->height - 1);
 
-  for(int x = 0; (x < grid->width) && is_generating; x++)
+  gen_deadline = 0;
+
+  if (gen_status != GEN_DONE)
+  {
+    grid_free(&grid);
+
+    return NULL;
+  }
+
+  return grid;
+}
+
+/*
+ * Generate crossword grid
+ */
+grid_t* grid_gen(wbase_t* wbase, grid_t* model)
+{
+  return grid_timed_gen(wbase, model, MAX_GEN_TIME);
+}
+
+/*
+ * Generate crossword grid with as many theme words as possible
+ *
+ * Every generation restarts from the model, and has to beat the
+ * score of the best grid so far. It abandons the branches that
+ * can't contain enough theme words. The best score only changes
+ * between generations, so this is restart and prune,
+ * not a full branch and bound
+ *
+ * Every generation stops after THEME_GEN_TIME, and all of them
+ * together after MAX_GEN_TIME, or THEME_TIME without it
+ *
+ * PARAMS
+ * - int amount | Number of generations
+ *
+ * RETURN (grid_t* grid)
+ * - NULL | Failed to generate any grid
+ */
+grid_t* grid_theme_gen(wbase_t* wbase, grid_t* model, int amount)
+{
+  grid_t* best = NULL;
+
+  best_score = -1;
+
+  max_word_score = wbase->count - 1;
+
+  int theme_time = (MAX_GEN_TIME > 0) ? MAX_GEN_TIME : THEME_TIME;
+
+  time_t stop_time = time(NULL) + theme_time;
+
+  for(int index = 0; index < amount; index++)
   {
-    for(int y = 0; (y < grid->height) && is_generating; y++)
+    int time_left = stop_time - time(NULL);
+
+    if(time_left <= 0) break;
+
+    grid_t* grid = grid_timed_gen(wbase, model, MIN(THEME_GEN_TIME, time_left));
+
+    if(!grid)
     {
-      if(xy_square_is_done(grid, x, y)) continue;
-        
-      int gen_status = vert_word_gen(wbase, grid, x, y);
+      // The generation was stopped, not timed out or failed
+      if(gen_is_stopped()) break;
 
-      if (gen_status == GEN_STOP || gen_status == GEN_FAIL)
-      {
-        grid_free(&grid);
+      continue;
+    }
 
-        return NULL;
-      }
+    if(grid->score > best_score)
+    {
+      info_print("Generated grid with score: %d", grid->score);
+
+      grid_free(&best);
+
+      best = grid;
+
+      best_score = grid->score;
     }
+    else grid_free(&grid);
+
+    // Without theme words, there is nothing to optimize
+    if(max_word_score == 0) break;
   }
 
-  is_generating = false;
+  best_score = -1;
 
-  return grid;
+  return best;
 }
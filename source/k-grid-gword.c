@@ -16,7 +16,7 @@ static void gwords_shuffle(gword_t* gwords, size_t count)
 {
   for(size_t index = 0; index < count; index++)
   {
-    size_t rand_index = (rand() % count);
+    size_t rand_index = (rand_get() % count);
 
     gword_t temp_gword = gwords[index];
 
@@ -47,23 +47,18 @@ void gwords_free(gword_t** gwords, size_t count)
 #define CAPACITY(n) (1ULL << (64 - __builtin_clzll(n)))
 
 /*
- * This function searches for words fitting the pattern,
- * and labels them as gword_t with start and stop
+ * This function labels words as gword_t with start and stop,
+ * and appends them to gwords
  *
- * The function allocates memory for gwords,
- * which the user will have to free
+ * The strings of words are reused by gwords,
+ * and the array of words is freed
  *
  * RETURN (int status)
  * - 0 | Success
  * - 1 | Failed to allocate gwords
  */
-static int gwords_search(gword_t** gwords, size_t* count, trie_t* trie, trie_t* used_trie, const char* pattern, int start, int stop)
+static int gwords_append(gword_t** gwords, size_t* count, char** words, size_t word_count, int start, int stop)
 {
-  char** words = NULL;
-  size_t word_count = 0;
-
-  words_search(&words, &word_count, trie, used_trie, pattern);
-
   if (word_count == 0)
   {
     // No words to add
@@ -103,25 +98,6 @@ static int gwords_search(gword_t** gwords, size_t* count, trie_t* trie, trie_t*
   return 0;
 }
 
-/*
- * Get the full pattern of a horizontal line
- */
-int horiz_full_pattern_get(char* pattern, grid_t* grid, int y)
-{
-  for(int x = 0; x < grid->width; x++)
-  {
-    square_t* square = xy_square_get(grid, x, y);
-
-    if(!square) return 1;
-
-    pattern[x] = (square->type == SQUARE_LETTER) ? square->letter : '_';
-  }
-
-  pattern[grid->width] = '\0';
-
-  return 0;
-}
-
 /*
  * This struct is only used by these internal functions
  */
@@ -132,10 +108,32 @@ typedef struct gwords_t
 } gwords_t;
 
 /*
- * Search grid words from an array of word bases
+ * Search grid words of every span from start, into the grid words of their tiers
+ *
+ * The merged words of every tier are walked once for all the spans,
+ * and the words of every tier are added in the order of the stops
+ *
+ * EXPECTS:
+ * - stops are ascending
+ * - is_stop and stop_length are from span_stops_get
  */
-static void gwords_array_search(size_t* total_count, gwords_t* gwords_array, wbase_t* wbase, trie_t* used_trie, const char* pattern, int start, int stop)
+static void gwords_array_span_search(size_t* total_count, gwords_t* gwords_array, wbase_t* wbase, trie_t* used_trie, const char* line, int start, const int* stops, int stop_count, const bool* is_stop, int stop_length)
 {
+  size_t bucket_count = wbase->count * (stop_length + 1);
+
+  // The words of every span, by tier and length
+  char** words[bucket_count];
+  size_t counts[bucket_count];
+
+  memset(words,  0, sizeof(char**) * bucket_count);
+  memset(counts, 0, sizeof(size_t) * bucket_count);
+
+  if(wbase->darray)
+  {
+    darray_span_words_search(words, counts, wbase->darray, used_trie, line, is_stop, stop_length);
+  }
+  else span_words_search(words, counts, wbase->trie, used_trie, line, is_stop, stop_length);
+
   for(size_t index = 0; index < wbase->count; index++)
   {
     gword_t** curr_gwords = &gwords_array[index].gwords;
@@ -143,9 +141,19 @@ static void gwords_array_search(size_t* total_count, gwords_t* gwords_array, wba
 
     size_t old_count = *curr_count;
 
-    trie_t* curr_trie = wbase->tries[index];
+    char*** tier_words  = words  + (index * (stop_length + 1));
+    size_t* tier_counts = counts + (index * (stop_length + 1));
+
+    for(int stop_index = 0; stop_index < stop_count; stop_index++)
+    {
+      int stop = stops[stop_index];
+
+      if(stop == start) continue;
+
+      int length = (1 + stop - start);
 
-    gwords_search(curr_gwords, curr_count, curr_trie, used_trie, pattern, start, stop);
+      gwords_append(curr_gwords, curr_count, tier_words[length], tier_counts[length], start, stop);
+    }
 
     // Increase total_count by how many gwords was added
     *total_count += (*curr_count - old_count);
@@ -209,10 +217,10 @@ static void gwords_array_free(gwords_t* gwords_array, size_t count)
  */
 int horiz_gwords_get(gword_t** gwords, size_t* count, wbase_t* wbase, grid_t* grid, int cross_x, int cross_y)
 {
-  // 1. Create full pattern
-  char full_pattern[grid->width + 1];
+  // 1. Get full pattern
+  const char* full_pattern = horiz_full_pattern_get(grid, cross_y);
 
-  if(horiz_full_pattern_get(full_pattern, grid, cross_y) != 0)
+  if(!full_pattern)
   {
     return GWORDS_FAIL;
   }
@@ -241,25 +249,19 @@ int horiz_gwords_get(gword_t** gwords, size_t* count, wbase_t* wbase, grid_t* gr
 
   size_t total_count = 0;
 
-  char pattern[grid->width + 1];
-
+  // The spans from the same start are walked together
   for(int start_index = 0; start_index < start_count; start_index++)
   {
-    for(int stop_index = 0; stop_index < stop_count; stop_index++)
-    {
-      int start_x = start_xs[start_index];
-      int stop_x  = stop_xs[stop_index];
+    int start_x = start_xs[start_index];
 
-      // Don't bother the case where start and stop is cross_x
-      if(start_x == stop_x) continue;
+    bool is_stop[grid->width + 1];
+    memset(is_stop, false, sizeof(bool) * (grid->width + 1));
 
-      int length = (1 + stop_x - start_x);
+    int stop_length = span_stops_get(is_stop, start_x, stop_xs, stop_count);
 
-      // Create current pattern
-      sprintf(pattern, "%.*s", length, full_pattern + start_x);
+    if(stop_length == 0) continue;
 
-      gwords_array_search(&total_count, gwords_array, wbase, grid->words, pattern, start_x, stop_x);
-    }
+    gwords_array_span_search(&total_count, gwords_array, wbase, grid->words, full_pattern + start_x, start_x, stop_xs, stop_count, is_stop, stop_length);
   }
 
   if(total_count == 0)
@@ -288,34 +290,15 @@ int horiz_gwords_get(gword_t** gwords, size_t* count, wbase_t* wbase, grid_t* gr
   return GWORDS_DONE;
 }
 
-/*
- * Get the full pattern of a vertical line
- */
-int vert_full_pattern_get(char* pattern, grid_t* grid, int x)
-{
-  for(int y = 0; y < grid->height; y++)
-  {
-    square_t* square = xy_square_get(grid, x, y);
-
-    if(!square) return 1;
-
-    pattern[y] = (square->type == SQUARE_LETTER) ? square->letter : '_';
-  }
-
-  pattern[grid->height] = '\0';
-
-  return 0;
-}
-
 /*
  * Get the vertical grid words through cross x, y
  */
 int vert_gwords_get(gword_t** gwords, size_t* count, wbase_t* wbase, grid_t* grid, int cross_x, int cross_y)
 {
-  // 1. Create full pattern
-  char full_pattern[grid->height + 1];
+  // 1. Get full pattern
+  const char* full_pattern = vert_full_pattern_get(grid, cross_x);
 
-  if(vert_full_pattern_get(full_pattern, grid, cross_x) != 0)
+  if(!full_pattern)
   {
     return GWORDS_FAIL;
   }
@@ -344,25 +327,19 @@ int vert_gwords_get(gword_t** gwords, size_t* count, wbase_t* wbase, grid_t* gri
 
   size_t total_count = 0;
 
-  char pattern[grid->height + 1];
-
+  // The spans from the same start are walked together
   for(int start_index = 0; start_index < start_count; start_index++)
   {
-    for(int stop_index = 0; stop_index < stop_count; stop_index++)
-    {
-      int start_y = start_ys[start_index];
-      int stop_y  = stop_ys[stop_index];
+    int start_y = start_ys[start_index];
 
-      // Don't bother the case where start and stop is cross_y
-      if(start_y == stop_y) continue;
+    bool is_stop[grid->height + 1];
+    memset(is_stop, false, sizeof(bool) * (grid->height + 1));
 
-      int length = (1 + stop_y - start_y);
+    int stop_length = span_stops_get(is_stop, start_y, stop_ys, stop_count);
 
-      // Create current pattern
-      sprintf(pattern, "%.*s", length, full_pattern + start_y);
+    if(stop_length == 0) continue;
 
-      gwords_array_search(&total_count, gwords_array, wbase, grid->words, pattern, start_y, stop_y);
-    }
+    gwords_array_span_search(&total_count, gwords_array, wbase, grid->words, full_pattern + start_y, start_y, stop_ys, stop_count, is_stop, stop_length);
   }
 
   if(total_count == 0)
@@ -13,8 +13,9 @@
  * When inserting, the function:
  * - pastes the letters from the word
  * - pastes blocks before and after word
+ * - adds score, the looked up score of word, to the grid
  */
-int vert_word_insert(wbase_t* wbase, grid_t* grid, const char* word, int x, int start_y)
+int vert_word_insert(grid_t* grid, const char* word, int score, int x, int start_y)
 {
   bool is_perfect = true;
 
@@ -30,23 +31,22 @@ int vert_word_insert(wbase_t* wbase, grid_t* grid, const char* word, int x, int
     if(!old_square) break;
 
     // 2. Create the new square
-    square_t new_square =
-    {
-      .type = SQUARE_LETTER,
-      .letter = word[index],
-      .is_crossed = false
-    };
+    bool is_crossed = (square_type_get(old_square) == SQUARE_LETTER);
 
-    if(old_square->type == SQUARE_LETTER)
+    if(is_crossed)
     {
       grid->cross_count++;
-
-      new_square.is_crossed = true;
     }
     else is_perfect = false;
 
+    square_t new_square = square_letter_create(word[index], is_crossed);
+
     // 3. Assign the new square
+    grid->open_count += square_open_count_get(&new_square) - square_open_count_get(old_square);
+
     *old_square = new_square;
+
+    xy_pattern_sync(grid, x, y);
   }
   
 
@@ -55,9 +55,13 @@ int vert_word_insert(wbase_t* wbase, grid_t* grid, const char* word, int x, int
   {
     square_t* square = xy_square_get(grid, x, start_y + index);
 
-    if(square && square->type != SQUARE_BORDER) 
+    if(square && square_type_get(square) != SQUARE_BORDER) 
     {
-      square->type = SQUARE_BLOCK;
+      grid->open_count -= square_open_count_get(square);
+
+      square_type_set(square, SQUARE_BLOCK);
+
+      xy_pattern_sync(grid, x, start_y + index);
     }
   }
 
@@ -66,13 +70,19 @@ int vert_word_insert(wbase_t* wbase, grid_t* grid, const char* word, int x, int
   {
     square_t* square = xy_square_get(grid, x, start_y - 1);
 
-    if(square && square->type != SQUARE_BORDER) 
+    if(square && square_type_get(square) != SQUARE_BORDER) 
     {
-      square->type = SQUARE_BLOCK;
+      grid->open_count -= square_open_count_get(square);
+
+      square_type_set(square, SQUARE_BLOCK);
+
+      xy_pattern_sync(grid, x, start_y - 1);
     }
   }
 
-  trie_word_insert(grid->words, word);
+  grid_word_use(grid, word);
+
+  grid->score += score;
 
   return is_perfect ? INSERT_PERFECT : INSERT_DONE;
 }
@@ -83,8 +93,9 @@ int vert_word_insert(wbase_t* wbase, grid_t* grid, const char* word, int x, int
  * When inserting, the function:
  * - pastes the letters from the word
  * - pastes blocks before and after word
+ * - adds score, the looked up score of word, to the grid
  */
-int horiz_word_insert(wbase_t* wbase, grid_t* grid, const char* word, int start_x, int y)
+int horiz_word_insert(grid_t* grid, const char* word, int score, int start_x, int y)
 {
   bool is_perfect = true;
 
@@ -100,23 +111,22 @@ int horiz_word_insert(wbase_t* wbase, grid_t* grid, const char* word, int start_
     if(!old_square) break;
 
     // 2. Create the new square
-    square_t new_square =
-    {
-      .type = SQUARE_LETTER,
-      .letter = word[index],
-      .is_crossed = false
-    };
+    bool is_crossed = (square_type_get(old_square) == SQUARE_LETTER);
 
-    if(old_square->type == SQUARE_LETTER)
+    if(is_crossed)
     {
       grid->cross_count++;
-    
-      new_square.is_crossed = true;
     }
     else is_perfect = false;
 
+    square_t new_square = square_letter_create(word[index], is_crossed);
+
     // 3. Assign the new square
+    grid->open_count += square_open_count_get(&new_square) - square_open_count_get(old_square);
+
     *old_square = new_square;
+
+    xy_pattern_sync(grid, x, y);
   }
 
   // Insert block square at end of word
@@ -124,9 +134,13 @@ int horiz_word_insert(wbase_t* wbase, grid_t* grid, const char* word, int start_
   {
     square_t* square = xy_square_get(grid, start_x + index, y);
 
-    if(square && square->type != SQUARE_BORDER) 
+    if(square && square_type_get(square) != SQUARE_BORDER) 
     {
-      square->type = SQUARE_BLOCK;
+      grid->open_count -= square_open_count_get(square);
+
+      square_type_set(square, SQUARE_BLOCK);
+
+      xy_pattern_sync(grid, start_x + index, y);
     }
   }
 
@@ -135,21 +149,29 @@ int horiz_word_insert(wbase_t* wbase, grid_t* grid, const char* word, int start_
   {
     square_t* square = xy_square_get(grid, start_x - 1, y);
 
-    if(square && square->type != SQUARE_BORDER) 
+    if(square && square_type_get(square) != SQUARE_BORDER) 
     {
-      square->type = SQUARE_BLOCK;
+      grid->open_count -= square_open_count_get(square);
+
+      square_type_set(square, SQUARE_BLOCK);
+
+      xy_pattern_sync(grid, start_x - 1, y);
     }
   }
 
-  trie_word_insert(grid->words, word);
+  grid_word_use(grid, word);
+
+  grid->score += score;
 
   return is_perfect ? INSERT_PERFECT : INSERT_DONE;
 }
 
 /*
  * Remove non crossed letters of horizontal word
+ *
+ * The score has to be the same as when the word was inserted
  */
-void horiz_word_remove(grid_t* grid, const char* word, int start_x, int y)
+void horiz_word_remove(grid_t* grid, const char* word, int score, int start_x, int y)
 {
   for (int index = 0; word[index] != '\0'; index++)
   {
@@ -157,24 +179,27 @@ void horiz_word_remove(grid_t* grid, const char* word, int start_x, int y)
 
     square_t* square = xy_square_get(grid, x, y);
 
-    if (square && !square->is_crossed)
+    if (square && !square_is_crossed(square))
     {
-      *square = (square_t)
-      {
-        .type       = SQUARE_EMPTY,
-        .letter     = 0,
-        .is_crossed = false,
-      };
+      grid->open_count += 2 - square_open_count_get(square);
+
+      *square = square_create(SQUARE_EMPTY);
+
+      xy_pattern_sync(grid, x, y);
     }
   }
 
-  trie_word_remove(grid->words, word);
+  grid_word_unuse(grid, word);
+
+  grid->score -= score;
 }
 
 /*
  * Remove non crossed letters of vertical word
+ *
+ * The score has to be the same as when the word was inserted
  */
-void vert_word_remove(grid_t* grid, const char* word, int x, int start_y)
+void vert_word_remove(grid_t* grid, const char* word, int score, int x, int start_y)
 {
   for (int index = 0; word[index] != '\0'; index++)
   {
@@ -182,16 +207,17 @@ void vert_word_remove(grid_t* grid, const char* word, int x, int start_y)
 
     square_t* square = xy_square_get(grid, x, y);
 
-    if (square && !square->is_crossed)
+    if (square && !square_is_crossed(square))
     {
-      *square = (square_t)
-      {
-        .type       = SQUARE_EMPTY,
-        .letter     = 0,
-        .is_crossed = false,
-      };
+      grid->open_count += 2 - square_open_count_get(square);
+
+      *square = square_create(SQUARE_EMPTY);
+
+      xy_pattern_sync(grid, x, y);
     }
   }
 
-  trie_word_remove(grid->words, word);
+  grid_word_unuse(grid, word);
+
+  grid->score -= score;
 }
@@ -7,9 +7,11 @@
 
 #include <stdlib.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <string.h>
 #include <unistd.h>
+#include <time.h>
 
 // For debugging purpouses
 #include <signal.h>
@@ -28,6 +30,11 @@
 #define GWORDS_NO_WORDS 1
 #define GWORDS_FAIL     2
 #define GWORDS_SINGLE   3
+
+#define GEN_DONE 0
+#define GEN_FAIL 1
+#define GEN_STOP 2
+#define GEN_HALF 3
  
 /*
  * gword_t - grid word
@@ -50,23 +57,177 @@ typedef enum square_type_t
   SQUARE_EMPTY
 } square_type_t;
 
-typedef struct square_t
+/*
+ * A square is packed in one byte, so that grids are cheap to copy
+ *
+ * 7 6 5 4 3 2 1 0
+ * F T T L L L L L
+ *
+ * L | The lower 5 bits of the letter ('a' - 'z')
+ * T | The type of the square
+ * F | is_crossed if the square is a letter, otherwise is_prep
+ *
+ * A letter square is never a prep block, and only
+ * letter squares can be crossed, so they can share a bit
+ */
+typedef uint8_t square_t;
+
+#define SQUARE_LETTER_MASK 0x1f
+#define SQUARE_TYPE_MASK   0x60
+#define SQUARE_FLAG_MASK   0x80
+
+#define SQUARE_TYPE_SHIFT  5
+
+/*
+ * Create square of type, without letter or flag
+ */
+static inline square_t square_create(square_type_t type)
+{
+  return (type << SQUARE_TYPE_SHIFT);
+}
+
+/*
+ * Create letter square
+ */
+static inline square_t square_letter_create(char letter, bool is_crossed)
+{
+  return (SQUARE_LETTER << SQUARE_TYPE_SHIFT) |
+         (letter & SQUARE_LETTER_MASK) | (is_crossed ? SQUARE_FLAG_MASK : 0);
+}
+
+static inline square_type_t square_type_get(const square_t* square)
+{
+  return (*square & SQUARE_TYPE_MASK) >> SQUARE_TYPE_SHIFT;
+}
+
+/*
+ * RETURN (char letter)
+ * - '\0' | Square is not a letter
+ */
+static inline char square_letter_get(const square_t* square)
+{
+  if(square_type_get(square) != SQUARE_LETTER) return '\0';
+
+  return 0x60 | (*square & SQUARE_LETTER_MASK);
+}
+
+static inline bool square_is_crossed(const square_t* square)
+{
+  return (square_type_get(square) == SQUARE_LETTER) && (*square & SQUARE_FLAG_MASK);
+}
+
+static inline bool square_is_prep(const square_t* square)
+{
+  return (square_type_get(square) != SQUARE_LETTER) && (*square & SQUARE_FLAG_MASK);
+}
+
+/*
+ * Set the type of square
+ *
+ * The flag only survives if the square stays a letter or a non letter
+ */
+static inline void square_type_set(square_t* square, square_type_t type)
+{
+  bool was_letter = (square_type_get(square) == SQUARE_LETTER);
+
+  *square = (*square & ~SQUARE_TYPE_MASK) | (type << SQUARE_TYPE_SHIFT);
+
+  if(was_letter != (type == SQUARE_LETTER)) *square &= ~SQUARE_FLAG_MASK;
+}
+
+static inline void square_letter_set(square_t* square, char letter)
+{
+  *square = (*square & ~SQUARE_LETTER_MASK) | (letter & SQUARE_LETTER_MASK);
+}
+
+/*
+ * Set is_crossed of a letter square
+ */
+static inline void square_crossed_set(square_t* square, bool is_crossed)
+{
+  if(square_type_get(square) != SQUARE_LETTER) return;
+
+  if(is_crossed) *square |=  SQUARE_FLAG_MASK;
+  else           *square &= ~SQUARE_FLAG_MASK;
+}
+
+/*
+ * Set is_prep of a non letter square
+ */
+static inline void square_prep_set(square_t* square, bool is_prep)
 {
-  square_type_t type;
-  char          letter;
-  bool          is_crossed;
-  bool          is_prep;
-} square_t;
+  if(square_type_get(square) == SQUARE_LETTER) return;
+
+  if(is_prep) *square |=  SQUARE_FLAG_MASK;
+  else        *square &= ~SQUARE_FLAG_MASK;
+}
+
+/*
+ * Get the number of unfilled directions of square, see grid_t
+ */
+static inline int square_open_count_get(const square_t* square)
+{
+  if(square_type_get(square) == SQUARE_EMPTY) return 2;
+
+  return (square_type_get(square) == SQUARE_LETTER && !square_is_crossed(square)) ? 1 : 0;
+}
+
+/*
+ * Besides the squares, a grid keeps some state in sync with them,
+ * so that it doesn't have to be built every time:
+ *
+ * patterns | The letters of every row and column, followed by a plane of
+ *            symbols with the same layout, which also has the type of the
+ *            squares that are not letters. The columns are contiguous
+ * masks    | The blocks, borders and preps of every real row as bitmasks,
+ *            where bit x is real x, or NULL if the real width doesn't fit
+ * verdicts | The remembered verdicts of block_is_allowed for every square
+ *
+ * rows    | height patterns of width  + 1 chars
+ * columns | width  patterns of height + 1 chars
+ * masks   | 3 * (height + 5) masks
+ *
+ * The words_hash is the xor of the hashes of the used words,
+ * so it is the same every time the same words are used.
+ * The used words must only be changed by grid_word_use and grid_word_unuse
+ *
+ * The open_count is the number of unfilled directions of the squares.
+ * It is counted when a generation starts, and then kept like the score
+ * by the functions that insert and remove words
+ */
+#define MASK_MAX_WIDTH 64
+
+/*
+ * The remembered verdict of a square, see grid_t
+ */
+#define VERDICT_UNKNOWN   0
+#define VERDICT_ALLOWED   1
+#define VERDICT_FORBIDDEN 2
 
 typedef struct grid_t
 {
   square_t* squares;
+  char*     patterns;
+  uint64_t* masks;
+  uint8_t*  verdicts;
   int       width;
   int       height;
   int       cross_count;
+  int       score;
+  int       open_count;
   trie_t*   words;
+  uint64_t  words_hash;
 } grid_t;
 
+extern void grid_word_use(grid_t* grid, const char* word);
+
+extern void grid_word_unuse(grid_t* grid, const char* word);
+
+extern void grid_words_reset(grid_t* grid);
+
+extern int  grid_words_get(char*** words, size_t* count, grid_t* grid);
+
+
 extern bool vert_start_block_brakes_words(wbase_t* wbase, grid_t* grid, int block_x, int block_y);
 
 extern bool horiz_start_block_brakes_words(wbase_t* wbase, grid_t* grid, int block_x, int block_y);
@@ -76,9 +237,30 @@ extern bool vert_stop_block_brakes_words(wbase_t* wbase, grid_t* grid, int block
 extern bool horiz_stop_block_brakes_words(wbase_t* wbase, grid_t* grid, int block_x, int block_y);
 
 
-extern int vert_full_pattern_get(char* pattern, grid_t* grid, int x);
+extern const char* vert_full_pattern_get(grid_t* grid, int x);
+
+extern const char* horiz_full_pattern_get(grid_t* grid, int y);
 
-extern int horiz_full_pattern_get(char* pattern, grid_t* grid, int y);
+extern const char* vert_symbols_get(grid_t* grid, int x);
+
+extern const char* horiz_symbols_get(grid_t* grid, int y);
+
+extern size_t      grid_patterns_size_get(int width, int height);
+
+extern uint64_t*   grid_masks_create(int width, int height);
+
+extern size_t      grid_masks_size_get(int height);
+
+extern void        xy_pattern_sync(grid_t* grid, int x, int y);
+
+extern void        grid_patterns_sync(grid_t* grid);
+
+
+extern size_t      grid_verdicts_size_get(int width, int height);
+
+extern void        xy_verdicts_forget(grid_t* grid, int x, int y);
+
+extern void        grid_verdicts_forget(grid_t* grid);
 
 
 extern int vert_word_fits(int* indexes, wbase_t* wbase, grid_t* grid, const char* word, int x, int start_y);
@@ -139,14 +321,14 @@ extern bool xy_real_square_is_border(grid_t* grid, int x, int y);
 extern bool xy_square_is_border(grid_t* grid, int x, int y);
 
 
-extern int  vert_word_insert(wbase_t* wbase, grid_t* grid, const char* word, int x, int start_y);
+extern int  vert_word_insert(grid_t* grid, const char* word, int score, int x, int start_y);
 
-extern void vert_word_remove(grid_t* grid, const char* word, int x, int start_y);
+extern void vert_word_remove(grid_t* grid, const char* word, int score, int x, int start_y);
 
 
-extern int  horiz_word_insert(wbase_t* wbase, grid_t* grid, const char* word, int start_x, int y);
+extern int  horiz_word_insert(grid_t* grid, const char* word, int score, int start_x, int y);
 
-extern void horiz_word_remove(grid_t* grid, const char* word, int start_x, int y);
+extern void horiz_word_remove(grid_t* grid, const char* word, int score, int start_x, int y);
 
 
 extern grid_t* grid_create(int width, int height);
@@ -159,6 +341,25 @@ extern grid_t* grid_dup(grid_t* grid);
 
 extern void    grid_prep(grid_t* grid);
 
+extern void    grid_cross_reset(grid_t* grid);
+
+
+extern int grid_area_gen(wbase_t* wbase, grid_t* grid, int start_x, int start_y, int stop_x, int stop_y);
+
+extern void gen_track_set(bool is_tracked);
+
+extern void gen_flag_set(bool* is_running);
+
+extern void gen_deadline_set(time_t deadline);
+
+
+extern void rand_seed_set(unsigned int seed);
+
+extern int  rand_get(void);
+
+
+extern char square_symbol_get(square_t* square);
+
 
 extern void grid_print(grid_t* grid);
 
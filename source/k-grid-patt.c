@@ -17,11 +17,237 @@
 
 #include "k-stats.h"
 
+#include <pthread.h>
+
 /*
  *
  */
 int MAX_CROWD_AMOUNT = 2;
 
+/*
+ * Get bit x of a row mask
+ */
+#define MASK_BIT(mask, x) (((mask) >> (x)) & 1)
+
+/*
+ * The row masks of the grid, see grid_t
+ */
+#define BLOCKS(grid)  ((grid)->masks)
+#define BORDERS(grid) ((grid)->masks + ((grid)->height + 5))
+#define PREPS(grid)   ((grid)->masks + ((grid)->height + 5) * 2)
+
+/*
+ * The block and trap rules only look at a few squares around the new block.
+ * Every rule gets a table with the answer for every state of its squares,
+ * so checking a rule is to build the signature and do one table load
+ *
+ * A square is open (0), block (1) or border (2), which is 2 bits
+ * of the signature. Letters and empty squares are both open
+ */
+#define CODE_OPEN   0
+#define CODE_BLOCK  1
+#define CODE_BORDER 2
+
+#define CODE_IS_BLOCK(code)    ((code) == CODE_BLOCK)
+#define CODE_IS_BORDER(code)   ((code) == CODE_BORDER)
+#define CODE_IS_BLOCKING(code) ((code) != CODE_OPEN)
+
+#define RULE_MAX_SQUARES 5
+
+#define RULE_TABLE_SIZE ((1 << (2 * RULE_MAX_SQUARES)) / 64)
+
+/*
+ * This struct is only used by these internal functions
+ */
+typedef struct rule_t
+{
+  int      square_count;
+  int      squares[RULE_MAX_SQUARES][2]; // x and y offset from new block
+  bool     (*is_forbidden)(const int* codes);
+  uint64_t table[RULE_TABLE_SIZE];       // Bit set if signature is forbidden
+} rule_t;
+
+/*
+ *  . . + a a
+ *  . . b . .
+ *  . . b . .
+ */
+static bool rule_below_is_forbidden(const int* c)
+{
+  return (CODE_IS_BLOCKING(c[0]) || CODE_IS_BLOCKING(c[1])) &&
+         (CODE_IS_BLOCKING(c[2]) || CODE_IS_BLOCKING(c[3]));
+}
+
+/*
+ *  . X _ . .   Both legal exceptions:
+ *  . . a + .   X _ over a, and a border
+ *  . . b . .   right to the left of +
+ *  . . b . .
+ */
+static bool rule_left_is_forbidden(const int* c)
+{
+  return (CODE_IS_BLOCK(c[0]) &&
+        !(CODE_IS_BORDER(c[1]) && !CODE_IS_BLOCKING(c[2])) &&
+         (CODE_IS_BLOCKING(c[3]) || CODE_IS_BLOCKING(c[4]))) ||
+          CODE_IS_BORDER(c[0]);
+}
+
+/*
+ *  X _ . . .
+ *  . a . + .
+ *  . b . . .
+ *  . b . . .
+ */
+static bool rule_far_left_is_forbidden(const int* c)
+{
+  return CODE_IS_BLOCK(c[0]) &&
+       !(CODE_IS_BORDER(c[1]) && !CODE_IS_BLOCKING(c[2])) &&
+        (CODE_IS_BLOCKING(c[3]) || CODE_IS_BLOCKING(c[4]));
+}
+
+/*
+ *  . . . X .
+ *  . . a b c
+ *  . . . . .
+ *  . . + . .
+ */
+static bool rule_far_above_is_forbidden(const int* c)
+{
+  return CODE_IS_BLOCK(c[0]) &&
+        (CODE_IS_BLOCKING(c[1]) ||
+        (CODE_IS_BLOCKING(c[2]) && !CODE_IS_BORDER(c[3])));
+}
+
+/*
+ *  . . . X .   A border right above +
+ *  . . a b c   is also forbidden
+ *  . . + . .
+ */
+static bool rule_above_is_forbidden(const int* c)
+{
+  return (CODE_IS_BLOCK(c[0]) &&
+         (CODE_IS_BLOCKING(c[1]) ||
+         (CODE_IS_BLOCKING(c[2]) && !CODE_IS_BORDER(c[3])))) ||
+          CODE_IS_BORDER(c[0]);
+}
+
+/*
+ * a . b
+ * . + .
+ * c . d
+ *
+ * A letter is trapped if (a or d) and (b or c) are blocks
+ */
+static bool rule_trap_is_forbidden(const int* c)
+{
+  return (CODE_IS_BLOCK(c[0]) || CODE_IS_BLOCK(c[3])) &&
+         (CODE_IS_BLOCK(c[1]) || CODE_IS_BLOCK(c[2]));
+}
+
+#define BLOCK_RULE_COUNT 5
+
+static rule_t block_rules[BLOCK_RULE_COUNT] =
+{
+  { .square_count = 4, .squares = { { 1, 0}, { 2, 0}, { 0, 1}, { 0, 2} },          .is_forbidden = rule_below_is_forbidden },
+  { .square_count = 5, .squares = { {-1, 0}, {-2,-1}, {-1,-1}, {-1, 1}, {-1, 2} }, .is_forbidden = rule_left_is_forbidden },
+  { .square_count = 5, .squares = { {-2, 0}, {-3,-1}, {-2,-1}, {-2, 1}, {-2, 2} }, .is_forbidden = rule_far_left_is_forbidden },
+  { .square_count = 4, .squares = { { 0,-2}, { 1,-2}, { 2,-2}, { 1,-3} },          .is_forbidden = rule_far_above_is_forbidden },
+  { .square_count = 4, .squares = { { 0,-1}, { 1,-1}, { 2,-1}, { 1,-2} },          .is_forbidden = rule_above_is_forbidden }
+};
+
+#define TRAP_RULE_COUNT 1
+
+static rule_t trap_rules[TRAP_RULE_COUNT] =
+{
+  { .square_count = 4, .squares = { {-1,-1}, { 1,-1}, {-1, 1}, { 1, 1} },          .is_forbidden = rule_trap_is_forbidden }
+};
+
+static pthread_once_t rule_tables_once = PTHREAD_ONCE_INIT;
+
+/*
+ * Fill the table of rule with the answer for every signature
+ */
+static void rule_table_build(rule_t* rule)
+{
+  int codes[RULE_MAX_SQUARES];
+
+  for(unsigned signature = 0; signature < (1U << (2 * rule->square_count)); signature++)
+  {
+    for(int index = 0; index < rule->square_count; index++)
+    {
+      codes[index] = (signature >> (2 * index)) & 3;
+    }
+
+    if(rule->is_forbidden(codes))
+    {
+      rule->table[signature / 64] |= (1ULL << (signature % 64));
+    }
+  }
+}
+
+/*
+ * Build the tables of every rule
+ *
+ * This is only done once, by the first thread checking a block
+ */
+static void rule_tables_build(void)
+{
+  for(int index = 0; index < BLOCK_RULE_COUNT; index++)
+  {
+    rule_table_build(&block_rules[index]);
+  }
+
+  for(int index = 0; index < TRAP_RULE_COUNT; index++)
+  {
+    rule_table_build(&trap_rules[index]);
+  }
+}
+
+/*
+ * Get the signature of the squares of rule around real x, y
+ */
+static unsigned rule_signature_get(grid_t* grid, const rule_t* rule, int real_x, int real_y)
+{
+  unsigned signature = 0;
+
+  for(int index = 0; index < rule->square_count; index++)
+  {
+    int x = real_x + rule->squares[index][0];
+    int y = real_y + rule->squares[index][1];
+
+    unsigned code = MASK_BIT(BLOCKS(grid)[y], x) | (MASK_BIT(BORDERS(grid)[y], x) << 1);
+
+    signature |= code << (2 * index);
+  }
+
+  return signature;
+}
+
+/*
+ * Check the rules against the row masks of the grid
+ *
+ * EXPECTS:
+ * - grid has row masks
+ * - (real_x, real_y) is not blocking
+ *
+ * RETURN (bool is_allowed)
+ */
+static bool rules_are_allowed(grid_t* grid, const rule_t* rules, int count, int real_x, int real_y)
+{
+  pthread_once(&rule_tables_once, rule_tables_build);
+
+  for(int index = 0; index < count; index++)
+  {
+    const rule_t* rule = &rules[index];
+
+    unsigned signature = rule_signature_get(grid, rule, real_x, real_y);
+
+    if(rule->table[signature / 64] & (1ULL << (signature % 64))) return false;
+  }
+
+  return true;
+}
+
 /*
  * Grid prepare blocks (blocks at top and left edges) only count for 1 block together
  *
@@ -60,9 +286,9 @@ static bool nerby_block_is_crowded(grid_t* grid, int real_x, int real_y)
 
       if (!square) return true;
 
-      if (square->type != SQUARE_BLOCK) continue;
+      if (square_type_get(square) != SQUARE_BLOCK) continue;
 
-      if (!square->is_prep)
+      if (!square_is_prep(square))
       {
         block_amount++;
 
@@ -82,6 +308,62 @@ static bool nerby_block_is_crowded(grid_t* grid, int real_x, int real_y)
   return false;
 }
 
+/*
+ * Count the blocks in the 3x3 window around real x, y
+ *
+ * All prep blocks together only count as 1 block
+ */
+static int mask_window_block_count(grid_t* grid, int real_x, int real_y)
+{
+  int block_amount = 0;
+
+  uint64_t prep_blocks = 0;
+
+  for(int y = (real_y - 1); y <= (real_y + 1); y++)
+  {
+    uint64_t blocks = BLOCKS(grid)[y];
+    uint64_t preps  = PREPS(grid)[y];
+
+    block_amount += __builtin_popcountll((blocks & ~preps) >> (real_x - 1) & 7);
+
+    prep_blocks |= (blocks & preps) >> (real_x - 1) & 7;
+  }
+
+  return block_amount + (prep_blocks ? 1 : 0);
+}
+
+/*
+ * Bitboard version of patt_crowd_is_allowed
+ *
+ * Every block that is not prep around the new block
+ * also gets crowded by the new block
+ */
+static bool mask_patt_crowd_is_allowed(grid_t* grid, int real_x, int real_y)
+{
+  if(mask_window_block_count(grid, real_x, real_y) > MAX_CROWD_AMOUNT)
+  {
+    return false;
+  }
+
+  for(int y = (real_y - 1); y <= (real_y + 1); y++)
+  {
+    uint64_t blocks = (BLOCKS(grid)[y] & ~PREPS(grid)[y]) >> (real_x - 1) & 7;
+
+    for(; blocks; blocks &= (blocks - 1))
+    {
+      int x = (real_x - 1) + __builtin_ctzll(blocks);
+
+      // The new block is not in the window of the nerby block yet
+      if(1 + mask_window_block_count(grid, x, y) > MAX_CROWD_AMOUNT)
+      {
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+
 /*
  *
  * This function checks if the pattern is crowded with block squares
@@ -100,6 +382,8 @@ static bool patt_crowd_is_allowed(grid_t* grid, int block_x, int block_y)
   int real_x = block_x + 3;
   int real_y = block_y + 3;
 
+  if(grid->masks) return mask_patt_crowd_is_allowed(grid, real_x, real_y);
+
   int block_amount = 0;
   bool nerby_prep = false;
 
@@ -111,9 +395,9 @@ static bool patt_crowd_is_allowed(grid_t* grid, int block_x, int block_y)
 
       if (!square) return false;
 
-      if (square->type != SQUARE_BLOCK) continue;
+      if (square_type_get(square) != SQUARE_BLOCK) continue;
 
-      if (!square->is_prep)
+      if (!square_is_prep(square))
       {
         block_amount++;
 
@@ -144,6 +428,8 @@ static bool patt_crowd_is_allowed(grid_t* grid, int block_x, int block_y)
  */
 static bool patt_trap_is_allowed(grid_t* grid, int block_x, int block_y)
 {
+  if(grid->masks) return rules_are_allowed(grid, trap_rules, TRAP_RULE_COUNT, block_x + 3, block_y + 3);
+
   /*
    * # . .
    * . + .
@@ -199,6 +485,8 @@ static bool patt_block_is_allowed(grid_t* grid, int block_x, int block_y)
   int real_x = block_x + 3;
   int real_y = block_y + 3;
 
+  if(grid->masks) return rules_are_allowed(grid, block_rules, BLOCK_RULE_COUNT, real_x, real_y);
+
   /*
    *  . . . . .
    *  . . . . .
@@ -341,21 +629,12 @@ static bool patt_block_is_allowed(grid_t* grid, int block_x, int block_y)
 }
 
 /*
- * Check if a blocking square is allowed
+ * Check if a blocking square is allowed, without remembering the verdict
  *
  * The order of the checks influence performance
  * The checks that catch most should be first
- *
- * The x and y is not accounting for border
- *
- * EXPECTS:
- * - block_x and block_y are inside grid
- *
- * PARAMS
- * - int block_x | Not real x
- * - int block_y | Not real y
  */
-bool block_is_allowed(grid_t* grid, int block_x, int block_y)
+static bool block_verdict_get(grid_t* grid, int block_x, int block_y)
 {
   // An already blocking square is of course allowed
   if(xy_square_is_blocking(grid, block_x, block_y))
@@ -402,3 +681,35 @@ bool block_is_allowed(grid_t* grid, int block_x, int block_y)
 
   return true;
 }
+
+/*
+ * Check if a blocking square is allowed
+ *
+ * The verdict is remembered until a square around it changes
+ *
+ * The x and y is not accounting for border
+ *
+ * EXPECTS:
+ * - block_x and block_y are inside grid
+ *
+ * PARAMS
+ * - int block_x | Not real x
+ * - int block_y | Not real y
+ */
+bool block_is_allowed(grid_t* grid, int block_x, int block_y)
+{
+  uint8_t* verdict = grid->verdicts + (block_y * grid->width) + block_x;
+
+  if(*verdict != VERDICT_UNKNOWN)
+  {
+    stats_patt_cache_incr();
+
+    return (*verdict == VERDICT_ALLOWED);
+  }
+
+  bool is_allowed = block_verdict_get(grid, block_x, block_y);
+
+  *verdict = is_allowed ? VERDICT_ALLOWED : VERDICT_FORBIDDEN;
+
+  return is_allowed;
+}
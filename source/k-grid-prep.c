@@ -150,9 +150,11 @@ static void grid_prep_top_blocks(grid_t* grid, int start_x, int start_y)
   {
     square_t* square = xy_real_square_get(grid, start_x + 1, start_y);
 
-    if(square && square->type == SQUARE_BLOCK)
+    if(square && square_type_get(square) == SQUARE_BLOCK)
     {
-      square->type = SQUARE_EMPTY;
+      square_type_set(square, SQUARE_EMPTY);
+
+      xy_pattern_sync(grid, start_x - 2, start_y - 3);
     }
   }
 
@@ -170,7 +172,7 @@ static void grid_prep_top_blocks(grid_t* grid, int start_x, int start_y)
     square_t* square = xy_real_square_get(grid, x, start_y);
 
     // Don't overwrite model letters
-    if(square->type == SQUARE_LETTER) continue;
+    if(square_type_get(square) == SQUARE_LETTER) continue;
 
     /*
      * This square gets to be a block if either:
@@ -178,12 +180,14 @@ static void grid_prep_top_blocks(grid_t* grid, int start_x, int start_y)
      * - the last square wasn't a block, or
      * - it randomly is decided to be one
      */
-    if (square->type == SQUARE_BLOCK ||
+    if (square_type_get(square) == SQUARE_BLOCK ||
         !last_is_block ||
-        (rand() % 100) > PREP_EMPTY_CHANCE)
+        (rand_get() % 100) > PREP_EMPTY_CHANCE)
     {
-      square->type    = SQUARE_BLOCK;
-      square->is_prep = true;
+      square_type_set(square, SQUARE_BLOCK);
+      square_prep_set(square, true);
+
+      xy_pattern_sync(grid, x - 3, start_y - 3);
 
       last_is_block = true;
     }
@@ -215,7 +219,7 @@ static void grid_prep_left_blocks(grid_t* grid, int start_x, int start_y)
     square_t* square = xy_real_square_get(grid, start_x, y);
 
     // Don't overwrite model letters
-    if(square->type == SQUARE_LETTER) continue;
+    if(square_type_get(square) == SQUARE_LETTER) continue;
 
     /*
      * This square gets to be a block if either:
@@ -223,12 +227,14 @@ static void grid_prep_left_blocks(grid_t* grid, int start_x, int start_y)
      * - the last square wasn't a block, or
      * - it randomly is decided to be one
      */
-    if (square->type == SQUARE_BLOCK ||
+    if (square_type_get(square) == SQUARE_BLOCK ||
         !last_is_block ||
-        (rand() % 100) > PREP_EMPTY_CHANCE)
+        (rand_get() % 100) > PREP_EMPTY_CHANCE)
     {
-      square->type    = SQUARE_BLOCK;
-      square->is_prep = true;
+      square_type_set(square, SQUARE_BLOCK);
+      square_prep_set(square, true);
+
+      xy_pattern_sync(grid, start_x - 3, y - 3);
 
       last_is_block = true;
     }
@@ -259,10 +265,13 @@ void grid_prep(grid_t* grid)
     square_t* square = real_square_get(grid, square_index);
 
     // Don't overwrite model letters
-    if(square->type == SQUARE_LETTER) continue;
+    if(square_type_get(square) == SQUARE_LETTER) continue;
+
+    square_type_set(square, SQUARE_BLOCK);
+    square_prep_set(square, true);
 
-    square->type    = SQUARE_BLOCK;
-    square->is_prep = true;
+    xy_pattern_sync(grid, real_index_x_get(grid, square_index) - 3,
+                          real_index_y_get(grid, square_index) - 3);
   }
 
   // 3. Randomly assign SQUARE_BLOCK to squares at edges
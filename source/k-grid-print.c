@@ -27,19 +27,19 @@ void grid_ncurses_print(grid_t* grid, int start_x, int start_y)
       int screen_x = start_x + (x * 2);
       int screen_y = start_y + y;
 
-      switch(square->type)
+      switch(square_type_get(square))
       {
         case SQUARE_LETTER:
-          if(square->is_crossed)
+          if(square_is_crossed(square))
           {
             attron(COLOR_PAIR(1));
-            mvprintw(screen_y, screen_x, "%c", square->letter);
+            mvprintw(screen_y, screen_x, "%c", square_letter_get(square));
             attroff(COLOR_PAIR(1));
           }
           else
           {
             attron(COLOR_PAIR(2));
-            mvprintw(screen_y, screen_x, "%c", square->letter);
+            mvprintw(screen_y, screen_x, "%c", square_letter_get(square));
             attroff(COLOR_PAIR(2));
           }
           break;
@@ -84,14 +84,14 @@ void grid_print(grid_t* grid)
 
       if(!square) continue;
 
-      switch(square->type)
+      switch(square_type_get(square))
       {
         case SQUARE_LETTER:
-          if(square->is_crossed)
+          if(square_is_crossed(square))
           {
-            printf("\033[32m%c \033[0m", square->letter);
+            printf("\033[32m%c \033[0m", square_letter_get(square));
           }
-          else printf("\033[37m%c \033[0m", square->letter);
+          else printf("\033[37m%c \033[0m", square_letter_get(square));
 
           break;
 
@@ -0,0 +1,754 @@
+/*
+ * k-grid-repair.c - repair unfilled parts of an almost done grid
+ *
+ * Instead of starting over, a window around an unfilled square
+ * is cleared and generated again, while the rest of grid is kept
+ *
+ * . . . . . . .
+ * . + + + + + .
+ * . + + + + + .
+ * . + + _ + + . The words touching the window (+) are cleared
+ * . + + + + + .
+ * . + + + + + .
+ * . . . . . . .
+ *
+ * When refilling, the selected words and the words crossing them
+ * are cleared instead, and only that region is generated again
+ */
+
+#include "k-grid.h"
+#include "k-grid-intern.h"
+
+#include "k-wbase.h"
+
+#include <ctype.h>
+
+extern int MAX_GEN_TIME;
+
+/*
+ * The distance from the unfilled square to the edge of the window
+ *
+ * The window grows every time it fails to be generated
+ */
+int REPAIR_MIN_RADIUS = 2;
+
+/*
+ * The number of windows that can fail in a row before giving up
+ */
+int MAX_REPAIR_AMOUNT = 100;
+
+/*
+ * The max number of seconds the generation of a single window can take
+ *
+ * A window that can't be filled is otherwise searched exhaustively
+ */
+int MAX_WINDOW_TIME = 2;
+
+/*
+ * This struct is only used by these internal functions
+ */
+typedef struct area_t
+{
+  int start_x;
+  int start_y;
+  int stop_x;
+  int stop_y;
+} area_t;
+
+/*
+ * The words that decide what is cleared
+ */
+typedef struct repair_t
+{
+  grid_t* model;        // Model letters and blocks are never cleared
+  trie_t* locks;        // Words that are never cleared
+  trie_t* refills;      // Words that are cleared and not used again
+  char**  refill_words;
+  size_t  refill_count;
+  time_t  deadline;     // When the repair has to stop, or 0
+} repair_t;
+
+/*
+ * Create an area that contains no squares
+ */
+static area_t area_empty(grid_t* grid)
+{
+  return (area_t)
+  {
+    .start_x = grid->width,
+    .start_y = grid->height,
+    .stop_x  = -1,
+    .stop_y  = -1
+  };
+}
+
+/*
+ * Check if x, y is inside area
+ */
+static bool area_contains(area_t* area, int x, int y)
+{
+  return (x >= area->start_x && x <= area->stop_x &&
+          y >= area->start_y && y <= area->stop_y);
+}
+
+/*
+ * Grow area so that it contains x, y
+ */
+static void area_expand(area_t* area, int x, int y)
+{
+  area->start_x = MIN(area->start_x, x);
+  area->start_y = MIN(area->start_y, y);
+  area->stop_x  = MAX(area->stop_x,  x);
+  area->stop_y  = MAX(area->stop_y,  y);
+}
+
+/*
+ * Check if the model has a letter at x, y
+ *
+ * Model letters are never cleared
+ */
+static bool model_square_is_letter(grid_t* model, int x, int y)
+{
+  return (model && xy_square_is_letter(model, x, y));
+}
+
+/*
+ * Check if the model has a block at x, y
+ */
+static bool model_square_is_block(grid_t* model, int x, int y)
+{
+  return (model && xy_square_is_block(model, x, y));
+}
+
+/*
+ * Get the horizontal word through x, y
+ *
+ * RETURN (int length)
+ */
+static int horiz_word_get(char* word, int* start_x, grid_t* grid, int x, int y)
+{
+  *start_x = x;
+  while(xy_square_is_letter(grid, *start_x - 1, y)) (*start_x)--;
+
+  int length = 0;
+
+  for(int curr_x = *start_x; xy_square_is_letter(grid, curr_x, y); curr_x++)
+  {
+    word[length++] = square_letter_get(xy_square_get(grid, curr_x, y));
+  }
+
+  word[length] = '\0';
+
+  return length;
+}
+
+/*
+ * Get the vertical word through x, y
+ *
+ * RETURN (int length)
+ */
+static int vert_word_get(char* word, int* start_y, grid_t* grid, int x, int y)
+{
+  *start_y = y;
+  while(xy_square_is_letter(grid, x, *start_y - 1)) (*start_y)--;
+
+  int length = 0;
+
+  for(int curr_y = *start_y; xy_square_is_letter(grid, x, curr_y); curr_y++)
+  {
+    word[length++] = square_letter_get(xy_square_get(grid, x, curr_y));
+  }
+
+  word[length] = '\0';
+
+  return length;
+}
+
+/*
+ * Check if the horizontal word through x, y is being refilled
+ */
+static bool horiz_word_is_refill(repair_t* repair, grid_t* grid, int x, int y)
+{
+  char word[grid->width + 1];
+  int  start_x;
+
+  if(horiz_word_get(word, &start_x, grid, x, y) < 2) return false;
+
+  return trie_word_exists(repair->refills, word);
+}
+
+/*
+ * Check if the vertical word through x, y is being refilled
+ */
+static bool vert_word_is_refill(repair_t* repair, grid_t* grid, int x, int y)
+{
+  char word[grid->height + 1];
+  int  start_y;
+
+  if(vert_word_get(word, &start_y, grid, x, y) < 2) return false;
+
+  return trie_word_exists(repair->refills, word);
+}
+
+/*
+ * Check if the horizontal word through x, y should be cleared
+ *
+ * RETURN (int status)
+ * - 0 | The letter is not part of a horizontal word
+ * - 1 | The word is kept
+ * - 2 | The word is cleared
+ */
+static int horiz_word_state_get(repair_t* repair, grid_t* grid, area_t* area, int x, int y)
+{
+  char word[grid->width + 1];
+  int  start_x;
+
+  int length = horiz_word_get(word, &start_x, grid, x, y);
+
+  if(length < 2) return 0;
+
+  int stop_x = start_x + length - 1;
+
+  if(trie_word_exists(repair->refills, word)) return 2;
+
+  if(trie_word_exists(repair->locks, word)) return 1;
+
+  if(y >= area->start_y && y <= area->stop_y &&
+      stop_x >= area->start_x && start_x <= area->stop_x)
+  {
+    return 2;
+  }
+
+  // Words crossing a refilled word has to make room for a new word
+  for(int curr_x = start_x; curr_x <= stop_x; curr_x++)
+  {
+    if(vert_word_is_refill(repair, grid, curr_x, y)) return 2;
+  }
+
+  return 1;
+}
+
+/*
+ * Check if the vertical word through x, y should be cleared
+ *
+ * RETURN (int status)
+ * - 0 | The letter is not part of a vertical word
+ * - 1 | The word is kept
+ * - 2 | The word is cleared
+ */
+static int vert_word_state_get(repair_t* repair, grid_t* grid, area_t* area, int x, int y)
+{
+  char word[grid->height + 1];
+  int  start_y;
+
+  int length = vert_word_get(word, &start_y, grid, x, y);
+
+  if(length < 2) return 0;
+
+  int stop_y = start_y + length - 1;
+
+  if(trie_word_exists(repair->refills, word)) return 2;
+
+  if(trie_word_exists(repair->locks, word)) return 1;
+
+  if(x >= area->start_x && x <= area->stop_x &&
+      stop_y >= area->start_y && start_y <= area->stop_y)
+  {
+    return 2;
+  }
+
+  // Words crossing a refilled word has to make room for a new word
+  for(int curr_y = start_y; curr_y <= stop_y; curr_y++)
+  {
+    if(horiz_word_is_refill(repair, grid, x, curr_y)) return 2;
+  }
+
+  return 1;
+}
+
+/*
+ * Check if a letter should be cleared
+ *
+ * A letter is kept if it is part of a word that is kept
+ */
+static bool letter_is_cleared(repair_t* repair, grid_t* grid, area_t* area, int x, int y)
+{
+  if(model_square_is_letter(repair->model, x, y)) return false;
+
+  int horiz_state = horiz_word_state_get(repair, grid, area, x, y);
+  int vert_state  = vert_word_state_get(repair, grid, area, x, y);
+
+  if(horiz_state == 1 || vert_state == 1) return false;
+
+  return (horiz_state == 2 || vert_state == 2 || area_contains(area, x, y));
+}
+
+/*
+ * Check if a block has any letters next to it
+ */
+static bool block_is_used(grid_t* grid, int x, int y)
+{
+  return (xy_square_is_letter(grid, x - 1, y) ||
+          xy_square_is_letter(grid, x + 1, y) ||
+          xy_square_is_letter(grid, x, y - 1) ||
+          xy_square_is_letter(grid, x, y + 1));
+}
+
+/*
+ * Clear the words that touch the area or cross a refilled word
+ *
+ * The letters that are also part of kept words are kept,
+ * and blocks that no longer are next to any letter are removed
+ *
+ * The area is expanded to contain all of the cleared squares,
+ * and the score is recomputed of the words that are left
+ */
+static void area_clear(repair_t* repair, wbase_t* wbase, grid_t* grid, area_t* area)
+{
+  // 1. Decide which letters to clear before clearing any of them
+  bool is_cleared[grid->width * grid->height];
+
+  for(int x = 0; x < grid->width; x++)
+  {
+    for(int y = 0; y < grid->height; y++)
+    {
+      is_cleared[y * grid->width + x] = xy_square_is_letter(grid, x, y) &&
+        letter_is_cleared(repair, grid, area, x, y);
+    }
+  }
+
+  area_t clear_area = *area;
+
+  // 2. Clear the letters
+  for(int x = 0; x < grid->width; x++)
+  {
+    for(int y = 0; y < grid->height; y++)
+    {
+      if(!is_cleared[y * grid->width + x]) continue;
+
+      square_t* square = xy_square_get(grid, x, y);
+
+      *square = square_create(SQUARE_EMPTY);
+
+      xy_pattern_sync(grid, x, y);
+
+      area_expand(&clear_area, x, y);
+    }
+  }
+
+  // 3. Remove the blocks that are left without letters
+  for(int x = clear_area.start_x; x <= clear_area.stop_x; x++)
+  {
+    for(int y = clear_area.start_y; y <= clear_area.stop_y; y++)
+    {
+      square_t* square = xy_square_get(grid, x, y);
+
+      if(square_type_get(square) != SQUARE_BLOCK || square_is_prep(square)) continue;
+
+      if(model_square_is_block(repair->model, x, y)) continue;
+
+      if(!block_is_used(grid, x, y))
+      {
+        square_type_set(square, SQUARE_EMPTY);
+
+        xy_pattern_sync(grid, x, y);
+      }
+    }
+  }
+
+  *area = clear_area;
+
+  // 4. Make the crossed letters, used words and score match the squares
+  grid_cross_reset(grid);
+
+  grid_words_reset(grid);
+
+  grid->score = 0;
+
+  char** words = NULL;
+  size_t count = 0;
+
+  if(grid_words_get(&words, &count, grid) == 0)
+  {
+    for(size_t index = 0; index < count; index++)
+    {
+      grid_word_use(grid, words[index]);
+
+      grid->score += wbase_word_score_get(wbase, words[index]);
+    }
+
+    words_free(&words, count);
+  }
+
+  // The refilled words are marked as used, so they are not picked again
+  for(size_t index = 0; index < repair->refill_count; index++)
+  {
+    grid_word_use(grid, repair->refill_words[index]);
+  }
+}
+
+/*
+ * Get the first square in the grid that is not done
+ *
+ * RETURN (bool does_exist)
+ */
+static bool unfilled_square_get(int* x, int* y, grid_t* grid)
+{
+  for(int curr_x = 0; curr_x < grid->width; curr_x++)
+  {
+    for(int curr_y = 0; curr_y < grid->height; curr_y++)
+    {
+      if(!xy_square_is_done(grid, curr_x, curr_y))
+      {
+        *x = curr_x;
+        *y = curr_y;
+
+        return true;
+      }
+    }
+  }
+
+  return false;
+}
+
+/*
+ * Get the window around x, y in grid
+ */
+static area_t window_area_get(grid_t* grid, int x, int y, int radius)
+{
+  return (area_t)
+  {
+    .start_x = MAX(0, x - radius),
+    .start_y = MAX(0, y - radius),
+    .stop_x  = MIN(grid->width  - 1, x + radius),
+    .stop_y  = MIN(grid->height - 1, y + radius)
+  };
+}
+
+/*
+ * Check if the window around x, y contains the whole grid
+ */
+static bool window_is_grid(grid_t* grid, int x, int y, int radius)
+{
+  area_t area = window_area_get(grid, x, y, radius);
+
+  return (area.start_x == 0 && area.stop_x == grid->width  - 1 &&
+          area.start_y == 0 && area.stop_y == grid->height - 1);
+}
+
+/*
+ * Check if the time of the repair has run out
+ */
+static bool repair_is_expired(repair_t* repair)
+{
+  return (repair->deadline != 0 && time(NULL) >= repair->deadline);
+}
+
+/*
+ * Generate the cleared area of grid
+ *
+ * The generation stops after MAX_WINDOW_TIME,
+ * or when the time of the whole repair runs out
+ *
+ * RETURN (int status)
+ * - GEN_DONE | The area is filled
+ * - GEN_FAIL | Failed to fill the area in time
+ * - GEN_STOP | The repair was stopped or ran out of time
+ */
+static int repair_area_gen(repair_t* repair, wbase_t* wbase, grid_t* grid, area_t* area)
+{
+  time_t deadline = time(NULL) + MAX_WINDOW_TIME;
+
+  if(repair->deadline != 0) deadline = MIN(deadline, repair->deadline);
+
+  gen_deadline_set(deadline);
+
+  int gen_status = grid_area_gen(wbase, grid, area->start_x, area->start_y, area->stop_x, area->stop_y);
+
+  gen_deadline_set(0);
+
+  // An area that timed out is a failed area, not a stopped repair
+  if(gen_status == GEN_STOP && is_generating && !repair_is_expired(repair))
+  {
+    gen_status = GEN_FAIL;
+  }
+
+  return gen_status;
+}
+
+/*
+ * Clear and generate the window around x, y in grid
+ *
+ * RETURN (int status)
+ * - GEN_DONE | The square at x, y is filled
+ * - GEN_FAIL | Failed to fill the window in time
+ * - GEN_STOP | The repair was stopped or ran out of time
+ */
+static int window_repair(repair_t* repair, wbase_t* wbase, grid_t* grid, int x, int y, int radius)
+{
+  area_t area = window_area_get(grid, x, y, radius);
+
+  grid_t* test_grid = grid_dup(grid);
+
+  if(!test_grid) return GEN_FAIL;
+
+  area_clear(repair, wbase, test_grid, &area);
+
+  int gen_status = repair_area_gen(repair, wbase, test_grid, &area);
+
+  if(gen_status == GEN_DONE && !xy_square_is_done(test_grid, x, y))
+  {
+    gen_status = GEN_FAIL;
+  }
+
+  if(gen_status == GEN_DONE)
+  {
+    grid_copy(grid, test_grid);
+  }
+
+  grid_free(&test_grid);
+
+  return gen_status;
+}
+
+/*
+ * Regenerate windows around the unfilled squares in grid,
+ * one at a time, until every square in the grid is done
+ *
+ * A window never grows into the whole grid,
+ * because then the repair would be a new generation
+ *
+ * RETURN (bool is_done)
+ */
+static bool windows_repair(repair_t* repair, wbase_t* wbase, grid_t* grid)
+{
+  int radius = REPAIR_MIN_RADIUS;
+  int fail_count = 0;
+
+  int x, y;
+
+  while(is_generating && unfilled_square_get(&x, &y, grid))
+  {
+    if(fail_count >= MAX_REPAIR_AMOUNT)
+    {
+      error_print("Failed to repair %d windows in a row", fail_count);
+      break;
+    }
+
+    if(repair_is_expired(repair))
+    {
+      error_print("Failed to repair grid in time");
+      break;
+    }
+
+    int repair_status = window_repair(repair, wbase, grid, x, y, radius);
+
+    if(repair_status == GEN_STOP) break;
+
+    if(repair_status == GEN_DONE)
+    {
+      radius = REPAIR_MIN_RADIUS;
+
+      fail_count = 0;
+    }
+    else
+    {
+      // Try a larger window next time, so other words can be fitted
+      if(window_is_grid(grid, x, y, radius + 1))
+      {
+        error_print("Failed to repair window at %d, %d", x, y);
+        break;
+      }
+
+      radius++;
+
+      fail_count++;
+    }
+  }
+
+  return !unfilled_square_get(&x, &y, grid);
+}
+
+/*
+ * Convert words to lowercase, like the letters of the grid
+ */
+static void words_lower(char** words, size_t count)
+{
+  for(size_t index = 0; index < count; index++)
+  {
+    for(char* letter = words[index]; *letter; letter++)
+    {
+      *letter = tolower((unsigned char) *letter);
+    }
+  }
+}
+
+/*
+ * Create trie of words
+ */
+static trie_t* words_trie_create(char** words, size_t count)
+{
+  trie_t* trie = trie_create();
+
+  for(size_t index = 0; index < count; index++)
+  {
+    trie_word_insert(trie, words[index]);
+  }
+
+  return trie;
+}
+
+/*
+ * Initialize the words that decide what is cleared
+ *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | The model don't match the grid
+ *
+ * The words are converted to lowercase in place
+ */
+static int repair_init(repair_t* repair, grid_t* model, grid_t* grid, char** refills, size_t refill_count, char** locks, size_t lock_count)
+{
+  if(model && (model->width  != grid->width ||
+                model->height != grid->height))
+  {
+    return 1;
+  }
+
+  words_lower(locks, lock_count);
+
+  words_lower(refills, refill_count);
+
+  *repair = (repair_t)
+  {
+    .model        = model,
+    .locks        = words_trie_create(locks, lock_count),
+    .refills      = words_trie_create(refills, refill_count),
+    .refill_words = refills,
+    .refill_count = refill_count,
+    .deadline     = (MAX_GEN_TIME > 0) ? time(NULL) + MAX_GEN_TIME : 0
+  };
+
+  return 0;
+}
+
+/*
+ * Free the tries of words that decide what is cleared
+ */
+static void repair_free(repair_t* repair)
+{
+  trie_free(&repair->locks);
+  trie_free(&repair->refills);
+}
+
+/*
+ * Repair a partially generated grid
+ *
+ * Windows around the unfilled squares are regenerated,
+ * one at a time, until every square in the grid is done
+ *
+ * PARAMS
+ * - grid_t* model | The model of the grid, to keep its letters and blocks
+ * - grid_t* grid  | The partially generated grid
+ * - char**  locks | Words that are never cleared
+ *
+ * RETURN (grid_t* grid)
+ * - NULL | Failed to repair grid
+ */
+grid_t* grid_repair(wbase_t* wbase, grid_t* model, grid_t* grid, char** locks, size_t lock_count)
+{
+  if(!grid) return NULL;
+
+  repair_t repair;
+
+  if(repair_init(&repair, model, grid, NULL, 0, locks, lock_count) != 0)
+  {
+    return NULL;
+  }
+
+  grid_t* repair_grid = grid_dup(grid);
+
+  if(repair_grid)
+  {
+    grid_cross_reset(repair_grid);
+
+    is_generating = true;
+
+    if(!windows_repair(&repair, wbase, repair_grid))
+    {
+      grid_free(&repair_grid);
+    }
+
+    is_generating = false;
+  }
+
+  repair_free(&repair);
+
+  return repair_grid;
+}
+
+/*
+ * Replace words in a generated grid
+ *
+ * Only the refilled words and the words crossing them are cleared,
+ * and only that region is generated again. If the region can't be
+ * filled, the grid is repaired with growing windows instead
+ *
+ * PARAMS
+ * - grid_t* model   | The model of the grid, to keep its letters and blocks
+ * - grid_t* grid    | The generated grid
+ * - char**  refills | Words that are replaced
+ * - char**  locks   | Words that are never cleared
+ *
+ * RETURN (grid_t* grid)
+ * - NULL | A refill word is not in grid, or failed to refill grid
+ */
+grid_t* grid_refill(wbase_t* wbase, grid_t* model, grid_t* grid, char** refills, size_t refill_count, char** locks, size_t lock_count)
+{
+  if(!grid) return NULL;
+
+  repair_t repair;
+
+  if(repair_init(&repair, model, grid, refills, refill_count, locks, lock_count) != 0)
+  {
+    return NULL;
+  }
+
+  for(size_t index = 0; index < refill_count; index++)
+  {
+    if(!trie_word_exists(grid->words, refills[index]))
+    {
+      error_print("Refill word is not in grid: %s", refills[index]);
+
+      repair_free(&repair);
+
+      return NULL;
+    }
+  }
+
+  grid_t* refill_grid = grid_dup(grid);
+
+  if(refill_grid)
+  {
+    grid_cross_reset(refill_grid);
+
+    area_t area = area_empty(refill_grid);
+
+    area_clear(&repair, wbase, refill_grid, &area);
+
+    is_generating = true;
+
+    int gen_status = repair_area_gen(&repair, wbase, refill_grid, &area);
+
+    if(gen_status == GEN_STOP || !windows_repair(&repair, wbase, refill_grid))
+    {
+      grid_free(&refill_grid);
+    }
+
+    is_generating = false;
+  }
+
+  repair_free(&repair);
+
+  return refill_grid;
+}
@@ -7,6 +7,14 @@
 
 int MAX_WORD_LENGTH = 40;
 
+/*
+ * Both SQUARE_BORDER and SQUARE_BLOCK is blocking
+ */
+static bool symbol_is_blocking(char symbol)
+{
+  return (symbol == '#' || symbol == 'X');
+}
+
 /*
  * Get start xs of horizontal words
  *
@@ -15,6 +23,10 @@ int MAX_WORD_LENGTH = 40;
  */
 bool horiz_start_xs_get(int* start_xs, int* count, grid_t* grid, int cross_x, int cross_y)
 {
+  const char* symbols = horiz_symbols_get(grid, cross_y);
+
+  if(!symbols) return true;
+
   bool is_blocked = true;
 
   for(int start_x = (cross_x + 1); start_x-- > 0;)
@@ -23,7 +35,7 @@ bool horiz_start_xs_get(int* start_xs, int* count, grid_t* grid, int cross_x, in
     if(cross_x - start_x >= MAX_WORD_LENGTH) break;
 
 
-    if(xy_square_is_blocking(grid, start_x, cross_y)) break;
+    if(symbol_is_blocking(symbols[start_x])) break;
 
     if(start_x < cross_x) is_blocked = false;
 
@@ -47,6 +59,10 @@ bool horiz_start_xs_get(int* start_xs, int* count, grid_t* grid, int cross_x, in
  */
 bool horiz_stop_xs_get(int* stop_xs, int* count, grid_t* grid, int cross_x, int cross_y)
 {
+  const char* symbols = horiz_symbols_get(grid, cross_y);
+
+  if(!symbols) return true;
+
   bool is_blocked = true;
 
   for(int stop_x = cross_x; stop_x < grid->width; stop_x++)
@@ -55,7 +71,7 @@ bool horiz_stop_xs_get(int* stop_xs, int* count, grid_t* grid, int cross_x, int
     if(stop_x - cross_x >= MAX_WORD_LENGTH) break;
 
 
-    if(xy_square_is_blocking(grid, stop_x, cross_y)) break;
+    if(symbol_is_blocking(symbols[stop_x])) break;
 
     if(stop_x > cross_x) is_blocked = false;
 
@@ -158,6 +174,10 @@ bool horiz_non_break_stop_xs_get(int* stop_xs, int* count, wbase_t* wbase, grid_
  */
 bool vert_start_ys_get(int* start_ys, int* count, grid_t* grid, int cross_x, int cross_y)
 {
+  const char* symbols = vert_symbols_get(grid, cross_x);
+
+  if(!symbols) return true;
+
   bool is_blocked = true;
 
   for(int start_y = (cross_y + 1); start_y-- > 0;)
@@ -166,7 +186,7 @@ bool vert_start_ys_get(int* start_ys, int* count, grid_t* grid, int cross_x, int
     if(cross_y - start_y >= MAX_WORD_LENGTH) break;
 
 
-    if(xy_square_is_blocking(grid, cross_x, start_y)) break;
+    if(symbol_is_blocking(symbols[start_y])) break;
 
     if(start_y < cross_y) is_blocked = false;
 
@@ -188,6 +208,10 @@ bool vert_start_ys_get(int* start_ys, int* count, grid_t* grid, int cross_x, int
  */
 bool vert_stop_ys_get(int* stop_ys, int* count, grid_t* grid, int cross_x, int cross_y)
 {
+  const char* symbols = vert_symbols_get(grid, cross_x);
+
+  if(!symbols) return true;
+
   bool is_blocked = true;
 
   for(int stop_y = cross_y; stop_y < grid->height; stop_y++)
@@ -196,7 +220,7 @@ bool vert_stop_ys_get(int* stop_ys, int* count, grid_t* grid, int cross_x, int c
     if(stop_y - cross_y >= MAX_WORD_LENGTH) break;
 
 
-    if(xy_square_is_blocking(grid, cross_x, stop_y)) break;
+    if(symbol_is_blocking(symbols[stop_y])) break;
 
     if(stop_y > cross_y) is_blocked = false;
 
@@ -287,3 +311,65 @@ bool vert_non_break_stop_ys_get(int* stop_ys, int* count, wbase_t* wbase, grid_t
 
   return false; // Is not blocked
 }
+
+/*
+ * Mark the lengths of the spans from start to every stop
+ *
+ * The span where start and stop is the same (1 letter) is skipped
+ *
+ * EXPECTS:
+ * - is_stop has room for the longest span + 1 items
+ *
+ * RETURN (int stop_length)
+ * - The length of the longest span
+ * - 0 | No spans from start
+ */
+int span_stops_get(bool* is_stop, int start, const int* stops, int stop_count)
+{
+  int stop_length = 0;
+
+  for(int index = 0; index < stop_count; index++)
+  {
+    // Don't bother the case where start and stop is the cross
+    if(stops[index] == start) continue;
+
+    int length = (1 + stops[index] - start);
+
+    is_stop[length] = true;
+
+    stop_length = MAX(stop_length, length);
+  }
+
+  return stop_length;
+}
+
+/*
+ * Mark the lengths of the spans from every start to stop
+ *
+ * The span where start and stop is the same (1 letter) is skipped
+ *
+ * EXPECTS:
+ * - is_start has room for the longest span + 1 items
+ *
+ * RETURN (int start_length)
+ * - The length of the longest span
+ * - 0 | No spans to stop
+ */
+int span_starts_get(bool* is_start, int stop, const int* starts, int start_count)
+{
+  int start_length = 0;
+
+  for(int index = 0; index < start_count; index++)
+  {
+    // Don't bother the case where start and stop is the cross
+    if(starts[index] == stop) continue;
+
+    int length = (1 + stop - starts[index]);
+
+    is_start[length] = true;
+
+    start_length = MAX(start_length, length);
+  }
+
+  return start_length;
+}
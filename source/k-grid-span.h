@@ -27,4 +27,8 @@ extern bool horiz_non_break_start_xs_get(int* start_xs, int* count, wbase_t* wba
 
 extern bool horiz_non_break_stop_xs_get(int* stop_xs, int* count, wbase_t* wbase, grid_t* grid, int cross_x, int cross_y);
 
+extern int  span_stops_get(bool* is_stop, int start, const int* stops, int stop_count);
+
+extern int  span_starts_get(bool* is_start, int stop, const int* starts, int start_count);
+
 #endif // K_GRID_SPAN_H
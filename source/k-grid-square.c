@@ -94,6 +94,258 @@ square_t* xy_square_get(grid_t* grid, int x, int y)
   return grid->squares + index;
 }
 
+/*
+ * Get the size of the row and column lines of a grid
+ */
+static size_t grid_lines_size_get(int width, int height)
+{
+  return (height * (width + 1)) + (width * (height + 1));
+}
+
+/*
+ * Get the size of the patterns and symbols of a grid
+ */
+size_t grid_patterns_size_get(int width, int height)
+{
+  return 2 * grid_lines_size_get(width, height);
+}
+
+/*
+ * Get the full pattern of a horizontal line
+ *
+ * The pattern is owned by the grid and is
+ * updated every time a square changes
+ *
+ * RETURN (const char* pattern)
+ * - NULL | Line is outside of grid
+ */
+const char* horiz_full_pattern_get(grid_t* grid, int y)
+{
+  if(y < 0 || y >= grid->height) return NULL;
+
+  return grid->patterns + (y * (grid->width + 1));
+}
+
+/*
+ * Get the full pattern of a vertical line
+ *
+ * The pattern is owned by the grid and is
+ * updated every time a square changes
+ *
+ * RETURN (const char* pattern)
+ * - NULL | Line is outside of grid
+ */
+const char* vert_full_pattern_get(grid_t* grid, int x)
+{
+  if(x < 0 || x >= grid->width) return NULL;
+
+  return grid->patterns + (grid->height * (grid->width + 1)) + (x * (grid->height + 1));
+}
+
+/*
+ * Get the symbols of a horizontal line
+ *
+ * RETURN (const char* symbols)
+ * - NULL | Line is outside of grid
+ */
+const char* horiz_symbols_get(grid_t* grid, int y)
+{
+  const char* pattern = horiz_full_pattern_get(grid, y);
+
+  if(!pattern) return NULL;
+
+  return pattern + grid_lines_size_get(grid->width, grid->height);
+}
+
+/*
+ * Get the symbols of a vertical line
+ *
+ * RETURN (const char* symbols)
+ * - NULL | Line is outside of grid
+ */
+const char* vert_symbols_get(grid_t* grid, int x)
+{
+  const char* pattern = vert_full_pattern_get(grid, x);
+
+  if(!pattern) return NULL;
+
+  return pattern + grid_lines_size_get(grid->width, grid->height);
+}
+
+/*
+ * Get the number of masks of a grid
+ */
+size_t grid_masks_size_get(int height)
+{
+  return 3 * (height + 5);
+}
+
+/*
+ * Allocate the masks of a grid
+ *
+ * RETURN (uint64_t* masks)
+ * - NULL | The grid is too wide or failed to allocate
+ */
+uint64_t* grid_masks_create(int width, int height)
+{
+  if((width + 5) > MASK_MAX_WIDTH) return NULL;
+
+  return malloc(sizeof(uint64_t) * grid_masks_size_get(height));
+}
+
+/*
+ * Update the block, border and prep bits of real square x, y
+ */
+static void xy_real_mask_sync(grid_t* grid, int x, int y)
+{
+  square_t* square = xy_real_square_get(grid, x, y);
+
+  int real_height = grid->height + 5;
+
+  uint64_t* block_mask  = grid->masks + y;
+  uint64_t* border_mask = grid->masks + y + real_height;
+  uint64_t* prep_mask   = grid->masks + y + real_height * 2;
+
+  uint64_t bit = (1ULL << x);
+
+  *block_mask  &= ~bit;
+  *border_mask &= ~bit;
+  *prep_mask   &= ~bit;
+
+  square_type_t type = square_type_get(square);
+
+  if(type == SQUARE_BLOCK)  *block_mask  |= bit;
+  if(type == SQUARE_BORDER) *border_mask |= bit;
+
+  if(square_is_prep(square)) *prep_mask |= bit;
+}
+
+/*
+ * The rules of a block look 3 squares up and left,
+ * and 2 squares down and right (the crowd rule)
+ */
+#define VERDICT_REACH_BEFORE 3
+#define VERDICT_REACH_AFTER  2
+
+/*
+ * Get the number of verdicts of a grid
+ */
+size_t grid_verdicts_size_get(int width, int height)
+{
+  return width * height;
+}
+
+/*
+ * Forget the verdicts of every square whose rules look at square x, y
+ *
+ * This has to be called every time the type or prep of a square changes
+ */
+void xy_verdicts_forget(grid_t* grid, int x, int y)
+{
+  int start_x = MAX(0, x - VERDICT_REACH_AFTER);
+  int start_y = MAX(0, y - VERDICT_REACH_AFTER);
+
+  int stop_x = MIN(grid->width  - 1, x + VERDICT_REACH_BEFORE);
+  int stop_y = MIN(grid->height - 1, y + VERDICT_REACH_BEFORE);
+
+  if(start_x > stop_x) return;
+
+  for(int forget_y = start_y; forget_y <= stop_y; forget_y++)
+  {
+    uint8_t* verdicts = grid->verdicts + (forget_y * grid->width);
+
+    memset(verdicts + start_x, VERDICT_UNKNOWN, sizeof(uint8_t) * (stop_x - start_x + 1));
+  }
+}
+
+/*
+ * Forget the verdicts of every square
+ */
+void grid_verdicts_forget(grid_t* grid)
+{
+  memset(grid->verdicts, VERDICT_UNKNOWN, sizeof(uint8_t) * grid_verdicts_size_get(grid->width, grid->height));
+}
+
+/*
+ * Update the row and column patterns, symbols and masks at square x, y
+ *
+ * This has to be called every time the type, letter or prep of a square changes
+ */
+void xy_pattern_sync(grid_t* grid, int x, int y)
+{
+  square_t* square = xy_square_get(grid, x, y);
+
+  if(!square) return;
+
+  if(grid->masks) xy_real_mask_sync(grid, x + 3, y + 3);
+
+  xy_verdicts_forget(grid, x, y);
+
+  char letter = (square_type_get(square) == SQUARE_LETTER) ? square_letter_get(square) : '_';
+
+  char symbol = square_symbol_get(square);
+
+  // x, y is inside the grid, so the lines exist
+  char* horiz_pattern = grid->patterns + (y * (grid->width + 1));
+  char* vert_pattern  = grid->patterns + (grid->height * (grid->width + 1)) + (x * (grid->height + 1));
+
+  size_t lines_size = grid_lines_size_get(grid->width, grid->height);
+
+  horiz_pattern[x] = letter;
+  vert_pattern[y]  = letter;
+
+  horiz_pattern[lines_size + x] = symbol;
+  vert_pattern[lines_size + y]  = symbol;
+}
+
+/*
+ * Rebuild every row and column pattern from the squares
+ */
+void grid_patterns_sync(grid_t* grid)
+{
+  grid_verdicts_forget(grid);
+
+  // The masks also have the border around the grid
+  if(grid->masks)
+  {
+    memset(grid->masks, 0, sizeof(uint64_t) * grid_masks_size_get(grid->height));
+
+    for(int x = 0; x < (grid->width + 5); x++)
+    {
+      for(int y = 0; y < (grid->height + 5); y++)
+      {
+        xy_real_mask_sync(grid, x, y);
+      }
+    }
+  }
+
+  for(int y = 0; y < grid->height; y++)
+  {
+    char* horiz_pattern = (char*) horiz_full_pattern_get(grid, y);
+    char* horiz_symbols = (char*) horiz_symbols_get(grid, y);
+
+    horiz_pattern[grid->width] = '\0';
+    horiz_symbols[grid->width] = '\0';
+  }
+
+  for(int x = 0; x < grid->width; x++)
+  {
+    char* vert_pattern = (char*) vert_full_pattern_get(grid, x);
+    char* vert_symbols = (char*) vert_symbols_get(grid, x);
+
+    vert_pattern[grid->height] = '\0';
+    vert_symbols[grid->height] = '\0';
+  }
+
+  for(int x = 0; x < grid->width; x++)
+  {
+    for(int y = 0; y < grid->height; y++)
+    {
+      xy_pattern_sync(grid, x, y);
+    }
+  }
+}
+
 /*
  * Set is_crossed flag to square in grid
  */
@@ -101,7 +353,14 @@ void xy_square_set_crossed(grid_t* grid, int x, int y)
 {
   square_t* square = xy_square_get(grid, x, y);
 
-  if(square) square->is_crossed = true;
+  if(square)
+  {
+    grid->open_count -= square_open_count_get(square);
+
+    square_crossed_set(square, true);
+
+    grid->open_count += square_open_count_get(square);
+  }
 
   grid->cross_count++;
 }
@@ -113,7 +372,9 @@ void xy_real_square_set_empty(grid_t* grid, int x, int y)
 {
   square_t* square = xy_real_square_get(grid, x, y);
 
-  if(square) square->type = SQUARE_EMPTY;
+  if(square) square_type_set(square, SQUARE_EMPTY);
+
+  xy_pattern_sync(grid, x - 3, y - 3);
 }
 
 /*
@@ -123,7 +384,7 @@ bool xy_real_square_is_block(grid_t* grid, int x, int y)
 {
   square_t* square = xy_real_square_get(grid, x, y);
 
-  return (square && square->type == SQUARE_BLOCK);
+  return (square && square_type_get(square) == SQUARE_BLOCK);
 }
 
 /*
@@ -133,7 +394,7 @@ bool xy_square_is_block(grid_t* grid, int x, int y)
 {
   square_t* square = xy_square_get(grid, x, y);
 
-  return (square && square->type == SQUARE_BLOCK);
+  return (square && square_type_get(square) == SQUARE_BLOCK);
 }
 
 /*
@@ -143,7 +404,7 @@ bool xy_square_is_letter(grid_t* grid, int x, int y)
 {
   square_t* square = xy_square_get(grid, x, y);
 
-  return (square && square->type == SQUARE_LETTER);
+  return (square && square_type_get(square) == SQUARE_LETTER);
 }
 
 /*
@@ -153,7 +414,7 @@ bool xy_square_is_crossed(grid_t* grid, int x, int y)
 {
   square_t* square = xy_square_get(grid, x, y);
 
-  return (square && square->is_crossed);
+  return (square && square_is_crossed(square));
 }
 
 /*
@@ -163,7 +424,7 @@ bool xy_real_square_is_border(grid_t* grid, int x, int y)
 {
   square_t* square = xy_real_square_get(grid, x, y);
 
-  return (square && square->type == SQUARE_BORDER);
+  return (square && square_type_get(square) == SQUARE_BORDER);
 }
 
 /*
@@ -173,7 +434,7 @@ bool xy_square_is_border(grid_t* grid, int x, int y)
 {
   square_t* square = xy_square_get(grid, x, y);
 
-  return (square && square->type == SQUARE_BORDER);
+  return (square && square_type_get(square) == SQUARE_BORDER);
 }
 
 /*
@@ -183,7 +444,9 @@ void xy_real_square_set_block(grid_t* grid, int x, int y)
 {
   square_t* square = xy_real_square_get(grid, x, y);
 
-  if(square) square->type = SQUARE_BLOCK;
+  if(square) square_type_set(square, SQUARE_BLOCK);
+
+  xy_pattern_sync(grid, x - 3, y - 3);
 }
 
 /*
@@ -193,8 +456,8 @@ bool xy_real_square_is_blocking(grid_t* grid, int x, int y)
 {
   square_t* square = xy_real_square_get(grid, x, y);
 
-  return (!square || square->type == SQUARE_BLOCK
-                  || square->type == SQUARE_BORDER);
+  return (!square || square_type_get(square) == SQUARE_BLOCK
+                  || square_type_get(square) == SQUARE_BORDER);
 }
 
 /*
@@ -204,8 +467,8 @@ bool xy_square_is_blocking(grid_t* grid, int x, int y)
 {
   square_t* square = xy_square_get(grid, x, y);
 
-  return (!square || square->type == SQUARE_BLOCK
-                  || square->type == SQUARE_BORDER);
+  return (!square || square_type_get(square) == SQUARE_BLOCK
+                  || square_type_get(square) == SQUARE_BORDER);
 }
 
 /*
@@ -215,6 +478,6 @@ bool xy_square_is_done(grid_t* grid, int x, int y)
 {
   square_t* square = xy_square_get(grid, x, y);
 
-  return !(square->type == SQUARE_EMPTY ||
-          (square->type == SQUARE_LETTER && !square->is_crossed));
+  return !(square_type_get(square) == SQUARE_EMPTY ||
+          (square_type_get(square) == SQUARE_LETTER && !square_is_crossed(square)));
 }
@@ -11,6 +11,8 @@
 
 #include "file.h"
 
+extern int MAX_WORD_LENGTH;
+
 /*
  * Extra SQUARE_BORDER squares are added around the grid
  *
@@ -50,10 +52,40 @@ grid_t* grid_create(int width, int height)
     return NULL;
   }
 
+  grid->patterns = malloc(sizeof(char) * grid_patterns_size_get(width, height));
+
+  if(!grid->patterns)
+  {
+    free(grid->squares);
+
+    free(grid);
+
+    return NULL;
+  }
+
+  grid->verdicts = malloc(sizeof(uint8_t) * grid_verdicts_size_get(width, height));
+
+  if(!grid->verdicts)
+  {
+    free(grid->patterns);
+
+    free(grid->squares);
+
+    free(grid);
+
+    return NULL;
+  }
+
+  grid->masks = grid_masks_create(width, height);
+
   grid->cross_count = 0;
+  grid->score       = 0;
+  grid->open_count  = 0;
 
   grid->words = trie_create();
 
+  grid->words_hash = 0;
+
   // Initialize empty squares and border squares
   for(int x = 0; x < (width + 5); x++)
   {
@@ -61,25 +93,20 @@ grid_t* grid_create(int width, int height)
     {
       square_t* square = xy_real_square_get(grid, x, y);
 
-      *square = (square_t)
-      {
-        .letter     = '\0',
-        .is_crossed = false,
-        .is_prep    = false
-      };
-
       if ((x >= 3) && (x < (width  + 3)) &&
           (y >= 3) && (y < (height + 3)))
       {
-        square->type = SQUARE_EMPTY;
+        *square = square_create(SQUARE_EMPTY);
       }
       else
       {
-        square->type = SQUARE_BORDER;
+        *square = square_create(SQUARE_BORDER);
       }
     }
   }
 
+  grid_patterns_sync(grid);
+
   return grid;
 }
 
@@ -99,16 +126,15 @@ grid_t* grid_clear(grid_t* grid)
     {
       square_t* square = xy_square_get(grid, x, y);
 
-      *square = (square_t)
-      {
-        .type = SQUARE_EMPTY,
-        .letter = '\0',
-        .is_crossed = false
-      };
+      *square = square_create(SQUARE_EMPTY);
     }
   }
 
+  grid_patterns_sync(grid);
+
   grid->cross_count = 0;
+  grid->score       = 0;
+  grid->open_count  = 0;
 
   return grid;
 }
@@ -140,9 +166,39 @@ grid_t* grid_copy(grid_t* copy, grid_t* grid)
 
   memcpy(copy->squares, grid->squares, sizeof(square_t) * real_count);
 
+  // The patterns, masks and verdicts could be rebuilt from the squares,
+  // but copying them is faster and keeps the remembered verdicts
+  size_t patterns_size = grid_patterns_size_get(grid->width, grid->height);
+
+  memcpy(copy->patterns, grid->patterns, sizeof(char) * patterns_size);
+
+  size_t verdicts_size = grid_verdicts_size_get(grid->width, grid->height);
+
+  memcpy(copy->verdicts, grid->verdicts, sizeof(uint8_t) * verdicts_size);
+
+  if(copy->masks && grid->masks)
+  {
+    memcpy(copy->masks, grid->masks, sizeof(uint64_t) * grid_masks_size_get(grid->height));
+  }
+  else
+  {
+    // Without masks to copy, the masks of copy would be out of sync
+    free(copy->masks);
+
+    copy->masks = NULL;
+  }
+
   copy->cross_count = grid->cross_count;
+  copy->score       = grid->score;
+  copy->open_count  = grid->open_count;
 
-  trie_copy(&copy->words, grid->words);
+  // trie_copy only keeps the words that copy already has,
+  // so the used words are duplicated to match words_hash
+  trie_free(&copy->words);
+
+  copy->words = trie_dup(grid->words);
+
+  copy->words_hash = grid->words_hash;
 
   return copy;
 }
@@ -177,13 +233,194 @@ grid_t* grid_dup(grid_t* grid)
 
   memcpy(dup->squares, grid->squares, sizeof(square_t) * real_count);
 
+  size_t patterns_size = grid_patterns_size_get(grid->width, grid->height);
+
+  dup->patterns = malloc(sizeof(char) * patterns_size);
+
+  if(!dup->patterns)
+  {
+    free(dup->squares);
+
+    free(dup);
+
+    return NULL;
+  }
+
+  memcpy(dup->patterns, grid->patterns, sizeof(char) * patterns_size);
+
+  size_t verdicts_size = grid_verdicts_size_get(grid->width, grid->height);
+
+  dup->verdicts = malloc(sizeof(uint8_t) * verdicts_size);
+
+  if(!dup->verdicts)
+  {
+    free(dup->patterns);
+
+    free(dup->squares);
+
+    free(dup);
+
+    return NULL;
+  }
+
+  memcpy(dup->verdicts, grid->verdicts, sizeof(uint8_t) * verdicts_size);
+
+  dup->masks = NULL;
+
+  if(grid->masks)
+  {
+    dup->masks = grid_masks_create(grid->width, grid->height);
+
+    if(dup->masks)
+    {
+      memcpy(dup->masks, grid->masks, sizeof(uint64_t) * grid_masks_size_get(grid->height));
+    }
+  }
+
   dup->cross_count = grid->cross_count;
+  dup->score       = grid->score;
+  dup->open_count  = grid->open_count;
 
   dup->words = trie_dup(grid->words);
 
+  dup->words_hash = grid->words_hash;
+
   return dup;
 }
 
+/*
+ * Hash a used word (FNV-1a), see grid_t
+ */
+static uint64_t used_word_hash(const char* word)
+{
+  uint64_t hash = 14695981039346656037ULL;
+
+  for(const char* letter = word; *letter; letter++)
+  {
+    hash ^= (uint8_t) *letter;
+    hash *= 1099511628211ULL;
+  }
+
+  return hash;
+}
+
+/*
+ * Mark word as used in grid
+ */
+void grid_word_use(grid_t* grid, const char* word)
+{
+  // The hash of a word is only added once
+  if(trie_word_exists(grid->words, word)) return;
+
+  trie_word_insert(grid->words, word);
+
+  grid->words_hash ^= used_word_hash(word);
+}
+
+/*
+ * Mark word as not used in grid
+ */
+void grid_word_unuse(grid_t* grid, const char* word)
+{
+  if(!trie_word_exists(grid->words, word)) return;
+
+  trie_word_remove(grid->words, word);
+
+  grid->words_hash ^= used_word_hash(word);
+}
+
+/*
+ * Mark every word as not used in grid
+ */
+void grid_words_reset(grid_t* grid)
+{
+  trie_free(&grid->words);
+
+  grid->words = trie_create();
+
+  grid->words_hash = 0;
+}
+
+/*
+ * Get the words in grid
+ *
+ * The function allocates an array of words, which has to be freed
+ *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | Bad input
+ */
+int grid_words_get(char*** words, size_t* count, grid_t* grid)
+{
+  if(!words || !count || !grid) return 1;
+
+  // Identify vertical words and remember them
+  for(int x = 3; x < (grid->width + 4); x++)
+  {
+    char word[grid->height + 1];
+    int  length = 0;
+
+    for(int y = 3; y < (grid->height + 4); y++)
+    {
+      square_t* square = xy_real_square_get(grid, x, y);
+
+      if(square_type_get(square) == SQUARE_EMPTY)
+      {
+        length = 0;
+      }
+      else if(square_type_get(square) == SQUARE_BLOCK || square_type_get(square) == SQUARE_BORDER)
+      {
+        if(length > 1)
+        {
+          word[length++] = '\0';
+
+          words_append(words, count, word);
+        }
+
+        length = 0;
+      }
+      else if(square_type_get(square) == SQUARE_LETTER)
+      {
+        word[length++] = square_letter_get(square);
+      }
+    }
+  }
+
+  // Identify horizontal words and remember them
+  for(int y = 2; y < (grid->height + 4); y++)
+  {
+    char word[grid->width + 1];
+    int  length = 0;
+
+    for(int x = 2; x < (grid->width + 4); x++)
+    {
+      square_t* square = xy_real_square_get(grid, x, y);
+
+      if(square_type_get(square) == SQUARE_EMPTY)
+      {
+        length = 0;
+      }
+      else if(square_type_get(square) == SQUARE_BLOCK || square_type_get(square) == SQUARE_BORDER)
+      {
+        if(length > 1)
+        {
+          word[length++] = '\0';
+
+          words_append(words, count, word);
+        }
+
+        length = 0;
+      }
+      else if(square_type_get(square) == SQUARE_LETTER)
+      {
+        word[length++] = square_letter_get(square);
+      }
+    }
+  }
+
+  return 0;
+}
+
 /*
  * Free crossword grid struct
  *
@@ -195,6 +432,12 @@ void grid_free(grid_t** grid)
 
   free((*grid)->squares);
 
+  free((*grid)->patterns);
+
+  free((*grid)->masks);
+
+  free((*grid)->verdicts);
+
   trie_free(&(*grid)->words);
 
   free(*grid);
@@ -203,23 +446,14 @@ void grid_free(grid_t** grid)
 }
 
 /*
- * Load grid from model
+ * Load grid from file of model or grid format
  *
  * RETURN (grid_t* grid)
  */
-grid_t* model_load(char* name)
+static grid_t* grid_file_load(char* file)
 {
-  if (!name) return NULL;
-
-  char model_file[1024];
-
-  if (model_file_get(model_file, name) != 0)
-  {
-    return NULL;
-  }
-
-  // 1. Read model file
-  size_t file_size = file_size_get(model_file);
+  // 1. Read grid file
+  size_t file_size = file_size_get(file);
 
   if (file_size == 0)
   {
@@ -228,7 +462,7 @@ grid_t* model_load(char* name)
 
   char* buffer = malloc(sizeof(char) * (file_size + 1));
 
-  if (file_read(buffer, file_size, model_file) == 0)
+  if (file_read(buffer, file_size, file) == 0)
   {
     free(buffer);
 
@@ -244,13 +478,16 @@ grid_t* model_load(char* name)
   int width  = 0;
   int height = 0;
 
-  char* token = strtok(buffer_copy, "\n");
+  // Batch workers load models at the same time
+  char* save = NULL;
+
+  char* token = strtok_r(buffer_copy, "\n", &save);
 
   for (height = 0; token; height++)
   {
     width = MAX(width, (strlen(token) + 1) / 2);
 
-    token = strtok(NULL, "\n");
+    token = strtok_r(NULL, "\n", &save);
   }
 
   if (width < 3 || height < 3)
@@ -266,7 +503,7 @@ grid_t* model_load(char* name)
 
   strcpy(buffer_copy, buffer);
 
-  token = strtok(buffer_copy, "\n");
+  token = strtok_r(buffer_copy, "\n", &save);
 
   for (int y = 0; (y < height) && token; y++)
   {
@@ -281,33 +518,35 @@ grid_t* model_load(char* name)
       switch (symbol)
       {
         case 'X':
-          square->type = SQUARE_BORDER;
+          square_type_set(square, SQUARE_BORDER);
           break;
 
         case '.':
-          square->type = SQUARE_EMPTY;
+          square_type_set(square, SQUARE_EMPTY);
           break;
 
         case '#':
-          square->type = SQUARE_BLOCK;
+          square_type_set(square, SQUARE_BLOCK);
           break;
 
         default:
           if (letter_index_get(symbol) != -1)
           {
-            square->type = SQUARE_LETTER;
+            square_type_set(square, SQUARE_LETTER);
 
-            square->letter = symbol;
+            square_letter_set(square, symbol);
           }
           break;
       }
     }
-    token = strtok(NULL, "\n");
+    token = strtok_r(NULL, "\n", &save);
   }
 
   free(buffer_copy);
   free(buffer);
 
+  grid_patterns_sync(grid);
+
   // Extract words in grid and store them
   char** words = NULL;
   size_t count = 0;
@@ -316,7 +555,7 @@ grid_t* model_load(char* name)
   {
     for (size_t index = 0; index < count; index++)
     {
-      trie_word_insert(grid->words, words[index]);
+      grid_word_use(grid, words[index]);
     }
 
     words_free(&words, count);
@@ -325,6 +564,168 @@ grid_t* model_load(char* name)
   return grid;
 }
 
+/*
+ * Load grid from model
+ *
+ * RETURN (grid_t* grid)
+ */
+grid_t* model_load(char* name)
+{
+  if (!name) return NULL;
+
+  char model_file[1024];
+
+  if (model_file_get(model_file, name) != 0)
+  {
+    return NULL;
+  }
+
+  return grid_file_load(model_file);
+}
+
+/*
+ * Get the length of the longest word that fits in model
+ *
+ * Blocks can be put in the open squares, so every shorter length
+ * fits too. Words are never longer than MAX_WORD_LENGTH
+ *
+ * RETURN (int length)
+ */
+int model_word_length_get(grid_t* model)
+{
+  int max_length = 0;
+
+  // 1. The longest horizontal run of open squares
+  for (int y = 0; y < model->height; y++)
+  {
+    int length = 0;
+
+    for (int x = 0; x < model->width; x++)
+    {
+      length = xy_square_is_blocking(model, x, y) ? 0 : (length + 1);
+
+      max_length = MAX(max_length, length);
+    }
+  }
+
+  // 2. The longest vertical run of open squares
+  for (int x = 0; x < model->width; x++)
+  {
+    int length = 0;
+
+    for (int y = 0; y < model->height; y++)
+    {
+      length = xy_square_is_blocking(model, x, y) ? 0 : (length + 1);
+
+      max_length = MAX(max_length, length);
+    }
+  }
+
+  return MIN(max_length, MAX_WORD_LENGTH);
+}
+
+/*
+ * Check if the letter at x, y is done in one direction
+ *
+ * A direction is done if the letter is part of a whole word,
+ * or if it is alone between two blocking squares
+ */
+static bool horiz_letter_is_done(grid_t* grid, int x, int y)
+{
+  int start_x = x;
+  while (xy_square_is_letter(grid, start_x - 1, y)) start_x--;
+
+  int stop_x = x;
+  while (xy_square_is_letter(grid, stop_x + 1, y)) stop_x++;
+
+  return (xy_square_is_blocking(grid, start_x - 1, y) &&
+          xy_square_is_blocking(grid, stop_x  + 1, y));
+}
+
+/*
+ * Check if the letter at x, y is done vertically
+ */
+static bool vert_letter_is_done(grid_t* grid, int x, int y)
+{
+  int start_y = y;
+  while (xy_square_is_letter(grid, x, start_y - 1)) start_y--;
+
+  int stop_y = y;
+  while (xy_square_is_letter(grid, x, stop_y + 1)) stop_y++;
+
+  return (xy_square_is_blocking(grid, x, start_y - 1) &&
+          xy_square_is_blocking(grid, x, stop_y  + 1));
+}
+
+/*
+ * Recalculate is_crossed and cross_count from the squares
+ *
+ * A letter is crossed when it is done both horizontally and vertically,
+ * which is the same state the generator would have left it in
+ */
+void grid_cross_reset(grid_t* grid)
+{
+  grid->cross_count = 0;
+
+  for (int x = 0; x < grid->width; x++)
+  {
+    for (int y = 0; y < grid->height; y++)
+    {
+      square_t* square = xy_square_get(grid, x, y);
+
+      square_crossed_set(square, horiz_letter_is_done(grid, x, y) &&
+                                 vert_letter_is_done(grid, x, y));
+
+      if (square_is_crossed(square)) grid->cross_count++;
+    }
+  }
+}
+
+/*
+ * Load a (partially) generated grid
+ *
+ * Blocks along the top and left borders are assumed to be prep blocks,
+ * as that information is not stored in the grid file
+ *
+ * RETURN (grid_t* grid)
+ */
+grid_t* grid_load(char* name)
+{
+  if (!name) return NULL;
+
+  char grid_file[1024];
+
+  if (grid_file_get(grid_file, name) != 0)
+  {
+    return NULL;
+  }
+
+  grid_t* grid = grid_file_load(grid_file);
+
+  if (!grid) return NULL;
+
+  for (int x = 0; x < grid->width; x++)
+  {
+    for (int y = 0; y < grid->height; y++)
+    {
+      square_t* square = xy_square_get(grid, x, y);
+
+      if (square_type_get(square) == SQUARE_BLOCK &&
+         (xy_real_square_is_border(grid, x + 3, y + 2) ||
+          xy_real_square_is_border(grid, x + 2, y + 3)))
+      {
+        square_prep_set(square, true);
+
+        xy_pattern_sync(grid, x, y);
+      }
+    }
+  }
+
+  grid_cross_reset(grid);
+
+  return grid;
+}
+
 /*
  * Export words to used words file
  */
@@ -445,6 +846,30 @@ static int words_export(grid_t* grid, char* name)
   return status;
 }
 
+/*
+ * Get the symbol of square, as written in grid and model files
+ */
+char square_symbol_get(square_t* square)
+{
+  switch (square_type_get(square))
+  {
+    case SQUARE_LETTER:
+      return square_letter_get(square);
+
+    case SQUARE_BLOCK:
+      return '#';
+
+    case SQUARE_EMPTY:
+      return '.';
+
+    case SQUARE_BORDER:
+      return 'X';
+
+    default:
+      return '\0';
+  }
+}
+
 /*
  * Export grid to file
  */
@@ -481,29 +906,7 @@ int grid_export(grid_t* grid, char* name)
 
       if (!square) continue;
 
-      char symbol = '\0';
-
-      switch (square->type)
-      {
-        case SQUARE_LETTER:
-          symbol = square->letter;
-          break;
-
-        case SQUARE_BLOCK:
-          symbol = '#';
-          break;
-
-        case SQUARE_EMPTY:
-          symbol = '.';
-          break;
-
-        case SQUARE_BORDER:
-          symbol = 'X';
-          break;
-
-        default:
-          break;
-      }
+      char symbol = square_symbol_get(square);
 
       if (x < (grid->width - 1))
       {
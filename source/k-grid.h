@@ -25,8 +25,20 @@ extern int     grid_export(grid_t* grid, char* name);
 
 extern grid_t* model_load(char* name);
 
+extern int     model_word_length_get(grid_t* model);
+
+extern grid_t* grid_load(char* name);
+
 extern grid_t* grid_gen(wbase_t* wbase, grid_t* model);
 
+extern grid_t* grid_theme_gen(wbase_t* wbase, grid_t* model, int amount);
+
+extern int     grid_batch_gen(char* manifest, int amount);
+
+extern grid_t* grid_repair(wbase_t* wbase, grid_t* model, grid_t* grid, char** locks, size_t lock_count);
+
+extern grid_t* grid_refill(wbase_t* wbase, grid_t* model, grid_t* grid, char** refills, size_t refill_count, char** locks, size_t lock_count);
+
 extern void    grid_free(grid_t** grid);
 
 #endif // K_GRID_H
@@ -3,6 +3,7 @@
  */
 
 #include <stddef.h>
+#include <stdbool.h>
 #include <pthread.h>
 #include <stdio.h>
 #include <ncurses.h>
@@ -17,6 +18,7 @@ typedef struct stats_patt_t
   size_t done;
   size_t block;
   size_t none;
+  size_t cache;
 } stats_patt_t;
 
 typedef struct stats_t
@@ -30,6 +32,12 @@ pthread_mutex_t stats_lock;
 
 stats_t stats;
 
+/*
+ * Batch workers don't count stats,
+ * because they would wait for each other on the lock
+ */
+static __thread bool stats_is_tracked = true;
+
 /*
  * Init stats object
  */
@@ -62,11 +70,21 @@ void stats_clear(void)
   pthread_mutex_unlock(&stats_lock);
 }
 
+/*
+ * Set if the stats of the calling thread should be counted
+ */
+void stats_track_set(bool is_tracked)
+{
+  stats_is_tracked = is_tracked;
+}
+
 /*
  * Increment stats pattern letter count
  */
 void stats_patt_letter_incr(void)
 {
+  if(!stats_is_tracked) return;
+
   pthread_mutex_lock(&stats_lock);
 
   stats.patt.letter++;
@@ -79,6 +97,8 @@ void stats_patt_letter_incr(void)
  */
 void stats_patt_trap_incr(void)
 {
+  if(!stats_is_tracked) return;
+
   pthread_mutex_lock(&stats_lock);
 
   stats.patt.trap++;
@@ -91,6 +111,8 @@ void stats_patt_trap_incr(void)
  */
 void stats_patt_crowd_incr(void)
 {
+  if(!stats_is_tracked) return;
+
   pthread_mutex_lock(&stats_lock);
 
   stats.patt.crowd++;
@@ -103,6 +125,8 @@ void stats_patt_crowd_incr(void)
  */
 void stats_patt_done_incr(void)
 {
+  if(!stats_is_tracked) return;
+
   pthread_mutex_lock(&stats_lock);
 
   stats.patt.done++;
@@ -115,6 +139,8 @@ void stats_patt_done_incr(void)
  */
 void stats_patt_block_incr(void)
 {
+  if(!stats_is_tracked) return;
+
   pthread_mutex_lock(&stats_lock);
 
   stats.patt.block++;
@@ -127,6 +153,8 @@ void stats_patt_block_incr(void)
  */
 void stats_patt_none_incr(void)
 {
+  if(!stats_is_tracked) return;
+
   pthread_mutex_lock(&stats_lock);
 
   stats.patt.none++;
@@ -134,11 +162,27 @@ void stats_patt_none_incr(void)
   pthread_mutex_unlock(&stats_lock);
 }
 
+/*
+ * Increment stats pattern cache count
+ */
+void stats_patt_cache_incr(void)
+{
+  if(!stats_is_tracked) return;
+
+  pthread_mutex_lock(&stats_lock);
+
+  stats.patt.cache++;
+
+  pthread_mutex_unlock(&stats_lock);
+}
+
 /*
  * Increment stats test count
  */
 void stats_test_incr(void)
 {
+  if(!stats_is_tracked) return;
+
   pthread_mutex_lock(&stats_lock);
 
   stats.test++;
@@ -159,7 +203,8 @@ void stats_ncurses_print(void)
   mvprintw(4, 1, "done  : %ld", stats.patt.done);
   mvprintw(5, 1, "block : %ld", stats.patt.block);
   mvprintw(6, 1, "none  : %ld", stats.patt.none);
-  mvprintw(7, 1, "test  : %ld", stats.test);
+  mvprintw(7, 1, "cache : %ld", stats.patt.cache);
+  mvprintw(8, 1, "test  : %ld", stats.test);
 
   pthread_mutex_unlock(&stats_lock);
 }
@@ -177,6 +222,7 @@ void stats_print(void)
   printf("done  : %ld\n", stats.patt.done);
   printf("block : %ld\n", stats.patt.block);
   printf("none  : %ld\n", stats.patt.none);
+  printf("cache : %ld\n", stats.patt.cache);
   printf("test  : %ld\n", stats.test);
 
   pthread_mutex_unlock(&stats_lock);
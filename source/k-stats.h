@@ -5,12 +5,16 @@
 #ifndef K_STATS_H
 #define K_STATS_H
 
+#include <stdbool.h>
+
 extern void stats_init(void);
 
 extern void stats_free(void);
 
 extern void stats_clear(void);
 
+extern void stats_track_set(bool is_tracked);
+
 
 extern void stats_patt_letter_incr(void);
 
@@ -24,6 +28,8 @@ extern void stats_patt_block_incr(void);
 
 extern void stats_patt_none_incr(void);
 
+extern void stats_patt_cache_incr(void);
+
 
 extern void stats_test_incr(void);
 
@@ -0,0 +1,147 @@
+/*
+ * k-wbase-cache.c - remember the answers of span queries
+ *
+ * The same spans are asked about again and again, by the fit checks,
+ * the brake checks and by the sibling candidates of a node.
+ * The answers are kept in a small table per thread, where a new
+ * answer replaces the old answer in the same slot
+ *
+ * A count depends on the used words, so the answer also has
+ * the hash of the used words, see grid_t. When a word is used,
+ * the hash changes and the old answers are never found again
+ */
+
+#include "k-wbase.h"
+#include "k-wbase-intern.h"
+
+#define CACHE_SIZE 2048
+
+/*
+ * The longest line that is remembered
+ */
+#define CACHE_MAX_LENGTH 32
+
+/*
+ * This struct is only used by these internal functions
+ */
+typedef struct answer_t
+{
+  wbase_t* wbase;       // NULL if the slot is empty
+  uint64_t used_hash;
+  uint64_t stops;       // Bit length is set if words of length are searched
+  int      kind;
+  int      length;
+  char     line[CACHE_MAX_LENGTH];
+  int      amount;
+  bool     is_capped;   // The amount was capped by the max amount
+} answer_t;
+
+static __thread answer_t cache[CACHE_SIZE];
+
+/*
+ * Convert the stop lengths to a bitmask
+ */
+static uint64_t stops_mask_get(const bool* is_stop, int stop_length)
+{
+  uint64_t stops = 0;
+
+  for(int length = 1; length <= stop_length; length++)
+  {
+    if(is_stop[length]) stops |= (1ULL << length);
+  }
+
+  return stops;
+}
+
+/*
+ * Get the slot of a query (FNV-1a)
+ */
+static answer_t* answer_slot_get(wbase_t* wbase, uint64_t used_hash, uint64_t stops, int kind, const char* line, int length)
+{
+  uint64_t hash = 14695981039346656037ULL;
+
+  for(int index = 0; index < length; index++)
+  {
+    hash ^= (uint8_t) line[index];
+    hash *= 1099511628211ULL;
+  }
+
+  hash ^= stops;
+  hash *= 1099511628211ULL;
+
+  hash ^= used_hash ^ (uintptr_t) wbase ^ kind;
+  hash *= 1099511628211ULL;
+
+  return &cache[(hash >> 32) % CACHE_SIZE];
+}
+
+/*
+ * Get the remembered amount of a query
+ *
+ * PARAMS
+ * - int kind       | The kind of query, see query_kind_t
+ * - int max_amount | The amount is at most max_amount
+ *
+ * RETURN (bool is_found)
+ */
+bool query_cache_get(int* amount, wbase_t* wbase, uint64_t used_hash, int kind, const char* line, const bool* is_stop, int stop_length, int max_amount)
+{
+  if(stop_length > CACHE_MAX_LENGTH) return false;
+
+  uint64_t stops = stops_mask_get(is_stop, stop_length);
+
+  answer_t* answer = answer_slot_get(wbase, used_hash, stops, kind, line, stop_length);
+
+  if ((answer->wbase     != wbase)       ||
+      (answer->used_hash != used_hash)   ||
+      (answer->stops     != stops)       ||
+      (answer->kind      != kind)        ||
+      (answer->length    != stop_length) ||
+      (memcmp(answer->line, line, sizeof(char) * stop_length) != 0))
+  {
+    return false;
+  }
+
+  // A capped amount is only known up to the old max amount
+  if(answer->is_capped && answer->amount < max_amount) return false;
+
+  *amount = MIN(answer->amount, max_amount);
+
+  return true;
+}
+
+/*
+ * Remember the amount of a query
+ *
+ * PARAMS
+ * - int max_amount | The max amount the query was asked with
+ */
+void query_cache_set(wbase_t* wbase, uint64_t used_hash, int kind, const char* line, const bool* is_stop, int stop_length, int amount, int max_amount)
+{
+  if(stop_length > CACHE_MAX_LENGTH) return;
+
+  uint64_t stops = stops_mask_get(is_stop, stop_length);
+
+  answer_t* answer = answer_slot_get(wbase, used_hash, stops, kind, line, stop_length);
+
+  answer->wbase     = wbase;
+  answer->used_hash = used_hash;
+  answer->stops     = stops;
+  answer->kind      = kind;
+  answer->length    = stop_length;
+  answer->amount    = amount;
+  answer->is_capped = (amount >= max_amount);
+
+  memcpy(answer->line, line, sizeof(char) * stop_length);
+}
+
+/*
+ * Forget every remembered answer of the calling thread
+ *
+ * This has to be done before the thread uses another word base
+ * at the same address, or when the words of a word base change
+ */
+void wbase_cache_clear(void)
+{
+  memset(cache, 0, sizeof(cache));
+}
@@ -0,0 +1,441 @@
+/*
+ * k-wbase-darray.c - search words in a double-array trie
+ *
+ * The nodes of a trie are states in two arrays, bases and checks.
+ * The child of a state with letter index is the state
+ * bases[state] + index, if checks of that state is the state.
+ * So a child is found with two lookups, and the arrays have no pointers
+ *
+ * The letters of every state are also kept,
+ * so wildcards only go through the children that exist
+ */
+
+#include "k-wbase.h"
+#include "k-wbase-intern.h"
+
+// __builtin_clzll counts the leading zeros, so the bit length is:
+#define CAPACITY(n) (1ULL << (64 - __builtin_clzll(n)))
+
+/*
+ * Get the child of state with letter index
+ *
+ * RETURN (int32_t child)
+ * - -1 | The state has no child with the letter
+ */
+static inline int32_t state_child_get(const darray_t* darray, int32_t state, int index)
+{
+  size_t child = (size_t) darray->bases[state] + index;
+
+  if(child >= darray->size || darray->checks[child] != state) return -1;
+
+  return child;
+}
+
+/*
+ * Free double array struct
+ *
+ * After the struct is freed, the pointer is set to NULL
+ */
+void darray_free(darray_t** darray)
+{
+  if(!darray || !(*darray)) return;
+
+  free((*darray)->bases);
+
+  free((*darray)->checks);
+
+  free((*darray)->letters);
+
+  free((*darray)->is_ends);
+
+  free((*darray)->tiers);
+
+  free(*darray);
+
+  *darray = NULL;
+}
+
+/*
+ * Make room for at least size states, the new states are free
+ *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | Failed to allocate memory
+ */
+static int darray_reserve(darray_t* darray, size_t size)
+{
+  if(size <= darray->size) return 0;
+
+  size_t new_size = CAPACITY(size);
+
+  int32_t* new_bases = realloc(darray->bases, sizeof(int32_t) * new_size);
+
+  if(!new_bases) return 1;
+
+  darray->bases = new_bases;
+
+  int32_t* new_checks = realloc(darray->checks, sizeof(int32_t) * new_size);
+
+  if(!new_checks) return 1;
+
+  darray->checks = new_checks;
+
+  uint32_t* new_letters = realloc(darray->letters, sizeof(uint32_t) * new_size);
+
+  if(!new_letters) return 1;
+
+  darray->letters = new_letters;
+
+  bool* new_is_ends = realloc(darray->is_ends, sizeof(bool) * new_size);
+
+  if(!new_is_ends) return 1;
+
+  darray->is_ends = new_is_ends;
+
+  uint8_t* new_tiers = realloc(darray->tiers, sizeof(uint8_t) * new_size);
+
+  if(!new_tiers) return 1;
+
+  darray->tiers = new_tiers;
+
+  for(size_t state = darray->size; state < new_size; state++)
+  {
+    darray->bases[state]   = 0;
+    darray->checks[state]  = -1;
+    darray->letters[state] = 0;
+    darray->is_ends[state] = false;
+    darray->tiers[state]   = 0;
+  }
+
+  darray->size = new_size;
+
+  return 0;
+}
+
+/*
+ * Check if every letter of letters has a free state from base
+ *
+ * RETURN (bool is_free)
+ */
+static bool base_is_free(darray_t* darray, int32_t base, uint32_t letters)
+{
+  for(; letters; letters &= (letters - 1))
+  {
+    size_t state = (size_t) base + __builtin_ctz(letters);
+
+    if(state < darray->size && darray->checks[state] != -1) return false;
+  }
+
+  return true;
+}
+
+/*
+ * Place the children of node, which is state, and every state under them
+ *
+ * PARAMS
+ * - size_t* first_free | No state before first_free is free
+ *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | Failed to allocate memory
+ */
+static int node_states_place(darray_t* darray, size_t* first_free, node_t* node, int32_t state)
+{
+  darray->is_ends[state] = node->is_end_of_word;
+
+  darray->tiers[state] = node->tier;
+
+  darray->letters[state] = node->letters;
+
+  if(node->letters == 0) return 0;
+
+  int first_letter = __builtin_ctz(node->letters);
+
+  // 1. Find the first base where every child has a free state
+  while(*first_free < darray->size && darray->checks[*first_free] != -1)
+  {
+    (*first_free)++;
+  }
+
+  size_t free_state = MAX(*first_free, (size_t) first_letter + 1);
+
+  for(;; free_state++)
+  {
+    if(free_state < darray->size && darray->checks[free_state] != -1) continue;
+
+    if(base_is_free(darray, free_state - first_letter, node->letters)) break;
+  }
+
+  int32_t base = (free_state - first_letter);
+
+  if(darray_reserve(darray, (size_t) base + ALPHABET_SIZE) != 0) return 1;
+
+  darray->bases[state] = base;
+
+  // 2. Take the states of the children, before any child places its own
+  for(uint32_t letters = node->letters; letters; letters &= (letters - 1))
+  {
+    darray->checks[base + __builtin_ctz(letters)] = state;
+  }
+
+  // 3. Place the states under every child
+  node_t** children = node->children;
+
+  for(uint32_t letters = node->letters; letters; letters &= (letters - 1))
+  {
+    int32_t child = base + __builtin_ctz(letters);
+
+    if(node_states_place(darray, first_free, *(children++), child) != 0) return 1;
+  }
+
+  return 0;
+}
+
+/*
+ * Create a double array with the words of trie
+ *
+ * The root is state 0
+ *
+ * RETURN (darray_t* darray)
+ * - NULL | Bad input or failed to allocate
+ */
+darray_t* darray_create(trie_t* trie)
+{
+  if(!trie) return NULL;
+
+  darray_t* darray = calloc(1, sizeof(darray_t));
+
+  if(!darray) return NULL;
+
+  if(darray_reserve(darray, 1024) != 0)
+  {
+    darray_free(&darray);
+
+    return NULL;
+  }
+
+  // The root is its own parent, so no child takes its state
+  darray->checks[0] = 0;
+
+  size_t first_free = 1;
+
+  if(node_states_place(darray, &first_free, (node_t*) trie, 0) != 0)
+  {
+    darray_free(&darray);
+
+    return NULL;
+  }
+
+  return darray;
+}
+
+/*
+ * Append word to array of words
+ *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | Failed to allocate memory
+ */
+static int word_append(char*** words, size_t* count, const char* word)
+{
+  if(*count == 0 || ((*count) + 1) >= CAPACITY(*count))
+  {
+    char** new_words = realloc(*words, sizeof(char*) * CAPACITY((*count) + 1));
+
+    if(!new_words) return 1;
+
+    *words = new_words;
+  }
+
+  (*words)[(*count)++] = strdup(word);
+
+  return 0;
+}
+
+/*
+ * Recursive function for searching words of every stop length
+ *
+ * PARAMS
+ * - char* word | Buffer of the letters sience root
+ */
+static void _darray_span_words_search(char*** words, size_t* counts, darray_t* darray, int32_t state, node_t* used_node, const char* line, const bool* is_stop, int stop_length, int index, char* word)
+{
+  if(is_stop[index] && darray->is_ends[state] &&
+     (!used_node || !used_node->is_end_of_word))
+  {
+    word[index] = '\0';
+
+    size_t bucket = (darray->tiers[state] * (stop_length + 1)) + index;
+
+    word_append(&words[bucket], &counts[bucket], word);
+  }
+
+  // Base case - the longest span is done
+  if(index >= stop_length) return;
+
+  // Search words with next letter
+  int letter_index = letter_index_get(line[index]);
+
+  if(letter_index != -1)
+  {
+    int32_t child = state_child_get(darray, state, letter_index);
+
+    // If no words have the letter, abort
+    if(child == -1) return;
+
+    node_t* used_child = used_node ? node_child_get(used_node, letter_index) : NULL;
+
+    word[index] = line[index];
+
+    _darray_span_words_search(words, counts, darray, child, used_child, line, is_stop, stop_length, index + 1, word);
+  }
+  else
+  {
+    int32_t base = darray->bases[state];
+
+    // Only go through the allocated letters
+    for(uint32_t letters = darray->letters[state]; letters; letters &= (letters - 1))
+    {
+      int child_index = __builtin_ctz(letters);
+
+      node_t* used_child = used_node ? node_child_get(used_node, child_index) : NULL;
+
+      word[index] = index_letter_get(child_index);
+
+      _darray_span_words_search(words, counts, darray, base + child_index, used_child, line, is_stop, stop_length, index + 1, word);
+    }
+  }
+}
+
+/*
+ * Search words of every stop length that match the start of line
+ *
+ * This is the same search as span_words_search, but in a double array
+ *
+ * EXPECTS:
+ * - words and counts have a bucket for every tier and length, see span_words_search
+ * - is_stop has stop_length + 1 items
+ */
+int darray_span_words_search(char*** words, size_t* counts, darray_t* darray, trie_t* used_trie, const char* line, const bool* is_stop, int stop_length)
+{
+  if(!words || !counts || !darray || !line || !is_stop) return 1;
+
+  char word[stop_length + 1];
+
+  _darray_span_words_search(words, counts, darray, 0, (node_t*) used_trie, line, is_stop, stop_length, 0, word);
+
+  return 0;
+}
+
+/*
+ * Recursive function for counting existing words of every stop length
+ *
+ * RETURN (int amount)
+ */
+static int _darray_span_words_exist(darray_t* darray, int32_t state, node_t* used_node, const char* line, const bool* is_stop, int stop_length, int index, int max_amount)
+{
+  // This evaluates to 0 if false and 1 if true
+  // which represents that 'a' word exist
+  int amount = (is_stop[index] && darray->is_ends[state] &&
+               (!used_node || !used_node->is_end_of_word));
+
+  // Base case - the longest span is done
+  if(index >= stop_length || amount >= max_amount)
+  {
+    return MIN(amount, max_amount);
+  }
+
+  // Search words with next letter
+  int letter_index = letter_index_get(line[index]);
+
+  if(letter_index != -1)
+  {
+    int32_t child = state_child_get(darray, state, letter_index);
+
+    // If no words have the letter, no more words exist
+    if(child == -1) return amount;
+
+    node_t* used_child = used_node ? node_child_get(used_node, letter_index) : NULL;
+
+    amount += _darray_span_words_exist(darray, child, used_child, line, is_stop, stop_length, index + 1, max_amount - amount);
+  }
+  else
+  {
+    int32_t base = darray->bases[state];
+
+    // Only go through the allocated letters
+    for(uint32_t letters = darray->letters[state]; letters; letters &= (letters - 1))
+    {
+      int child_index = __builtin_ctz(letters);
+
+      node_t* used_child = used_node ? node_child_get(used_node, child_index) : NULL;
+
+      amount += _darray_span_words_exist(darray, base + child_index, used_child, line, is_stop, stop_length, index + 1, max_amount - amount);
+
+      if(amount >= max_amount) break;
+    }
+  }
+
+  return MIN(amount, max_amount);
+}
+
+/*
+ * Count the words of double array that exist for the spans of line
+ *
+ * RETURN (int amount)
+ * - min | 0
+ * - max | max_amount
+ */
+int darray_span_words_exist(darray_t* darray, trie_t* used_trie, const char* line, const bool* is_stop, int stop_length, int max_amount)
+{
+  return _darray_span_words_exist(darray, 0, (node_t*) used_trie, line, is_stop, stop_length, 0, max_amount);
+}
+
+/*
+ * Recursive function for checking if a word of any stop length exists
+ *
+ * RETURN (bool does_exist)
+ */
+static bool _darray_span_word_exists(darray_t* darray, int32_t state, const char* line, const bool* is_stop, int stop_length, int index)
+{
+  if(is_stop[index] && darray->is_ends[state]) return true;
+
+  // Base case - the longest span is done
+  if(index >= stop_length) return false;
+
+  // Search words with next letter
+  int letter_index = letter_index_get(line[index]);
+
+  if(letter_index != -1)
+  {
+    int32_t child = state_child_get(darray, state, letter_index);
+
+    // If no words have the letter, no word exists
+    if(child == -1) return false;
+
+    return _darray_span_word_exists(darray, child, line, is_stop, stop_length, index + 1);
+  }
+
+  int32_t base = darray->bases[state];
+
+  // Only go through the allocated letters
+  for(uint32_t letters = darray->letters[state]; letters; letters &= (letters - 1))
+  {
+    if(_darray_span_word_exists(darray, base + __builtin_ctz(letters), line, is_stop, stop_length, index + 1))
+    {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+/*
+ * Check if a word of double array exists for the spans of line
+ *
+ * RETURN (bool does_exist)
+ */
+bool darray_span_word_exists(darray_t* darray, const char* line, const bool* is_stop, int stop_length)
+{
+  return _darray_span_word_exists(darray, 0, line, is_stop, stop_length, 0);
+}
@@ -0,0 +1,256 @@
+/*
+ * k-wbase-hash.c - hash set of exact words
+ *
+ * When every letter of a pattern is known, the pattern is either
+ * a word or not, so it is looked up with one hash probe instead of
+ * walking the trie letter by letter
+ */
+
+#include "k-wbase.h"
+#include "k-wbase-intern.h"
+
+extern int MAX_WORD_LENGTH;
+
+// __builtin_clzll counts the leading zeros, so the bit length is:
+#define CAPACITY(n) (1ULL << (64 - __builtin_clzll(n)))
+
+/*
+ * Hash the first length letters of word (FNV-1a)
+ */
+static uint32_t word_hash(const char* word, size_t length)
+{
+  uint32_t hash = 2166136261U;
+
+  for(size_t index = 0; index < length; index++)
+  {
+    hash ^= (uint8_t) word[index];
+    hash *= 16777619U;
+  }
+
+  return hash;
+}
+
+/*
+ * Append word to the letters of word set
+ *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | Failed to allocate memory
+ */
+static int wset_word_append(wset_t* wset, size_t* letter_count, const char* word, int length, int tier)
+{
+  size_t count = wset->count;
+
+  if(count == 0 || (count + 1) >= CAPACITY(count))
+  {
+    uint32_t* new_offsets = realloc(wset->offsets, sizeof(uint32_t) * CAPACITY(count + 1));
+
+    if(!new_offsets) return 1;
+
+    wset->offsets = new_offsets;
+
+    uint8_t* new_tiers = realloc(wset->tiers, sizeof(uint8_t) * CAPACITY(count + 1));
+
+    if(!new_tiers) return 1;
+
+    wset->tiers = new_tiers;
+  }
+
+  size_t letters = *letter_count;
+
+  if(letters == 0 || (letters + length + 1) >= CAPACITY(letters))
+  {
+    char* new_letters = realloc(wset->letters, sizeof(char) * CAPACITY(letters + length + 1));
+
+    if(!new_letters) return 1;
+
+    wset->letters = new_letters;
+  }
+
+  memcpy(wset->letters + letters, word, sizeof(char) * length);
+
+  wset->letters[letters + length] = '\0';
+
+  wset->tiers[wset->count] = tier;
+
+  wset->offsets[wset->count++] = letters;
+
+  *letter_count += (length + 1);
+
+  return 0;
+}
+
+/*
+ * Append every word under node to the letters of word set
+ *
+ * PARAMS
+ * - char* word | Buffer of the letters sience root
+ *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | Failed to allocate memory
+ */
+static int node_words_append(wset_t* wset, size_t* letter_count, node_t* node, char* word, int length)
+{
+  if(node->is_end_of_word)
+  {
+    if(wset_word_append(wset, letter_count, word, length, node->tier) != 0) return 1;
+  }
+
+  // Words longer than MAX_WORD_LENGTH are never loaded
+  if(length >= MAX_WORD_LENGTH) return 0;
+
+  node_t** children = node->children;
+
+  // Only go through the allocated letters
+  for(uint32_t letters = node->letters; letters; letters &= (letters - 1))
+  {
+    int index = __builtin_ctz(letters);
+
+    node_t* child = *(children++);
+
+    word[length] = index_letter_get(index);
+
+    if(node_words_append(wset, letter_count, child, word, length + 1) != 0) return 1;
+  }
+
+  return 0;
+}
+
+/*
+ * Free word set struct
+ *
+ * After the struct is freed, the pointer is set to NULL
+ */
+void wset_free(wset_t** wset)
+{
+  if(!wset || !(*wset)) return;
+
+  free((*wset)->letters);
+
+  free((*wset)->offsets);
+
+  free((*wset)->tiers);
+
+  free((*wset)->slots);
+
+  free(*wset);
+
+  *wset = NULL;
+}
+
+/*
+ * Create a word set with every word of trie
+ *
+ * The id of a word is the order it has in the trie
+ *
+ * RETURN (wset_t* wset)
+ * - NULL | Bad input or failed to allocate
+ */
+wset_t* wset_create(trie_t* trie)
+{
+  if(!trie) return NULL;
+
+  wset_t* wset = calloc(1, sizeof(wset_t));
+
+  if(!wset) return NULL;
+
+  // 1. Gather the letters of every word
+  size_t letter_count = 0;
+
+  char word[MAX_WORD_LENGTH + 1];
+
+  memset(word, '\0', sizeof(word));
+
+  if(node_words_append(wset, &letter_count, (node_t*) trie, word, 0) != 0)
+  {
+    wset_free(&wset);
+
+    return NULL;
+  }
+
+  // 2. Hash every word, at most half of the slots are used
+  wset->capacity = CAPACITY(2 * wset->count);
+
+  wset->slots = calloc(wset->capacity, sizeof(uint32_t));
+
+  if(!wset->slots)
+  {
+    wset_free(&wset);
+
+    return NULL;
+  }
+
+  size_t mask = (wset->capacity - 1);
+
+  for(size_t id = 0; id < wset->count; id++)
+  {
+    const char* curr_word = wset->letters + wset->offsets[id];
+
+    size_t slot = word_hash(curr_word, strlen(curr_word)) & mask;
+
+    while(wset->slots[slot] != 0)
+    {
+      slot = (slot + 1) & mask;
+    }
+
+    // The slots hold id + 1, because 0 is an empty slot
+    wset->slots[slot] = (id + 1);
+  }
+
+  return wset;
+}
+
+/*
+ * Get the id of the first length letters of word
+ *
+ * RETURN (int id)
+ * - -1 | The word is not in word set
+ */
+int wset_word_id_get(wset_t* wset, const char* word, size_t length)
+{
+  if(!wset || !word) return -1;
+
+  size_t mask = (wset->capacity - 1);
+
+  size_t slot = word_hash(word, length) & mask;
+
+  for(; wset->slots[slot] != 0; slot = (slot + 1) & mask)
+  {
+    uint32_t id = (wset->slots[slot] - 1);
+
+    const char* curr_word = wset->letters + wset->offsets[id];
+
+    if(strncmp(curr_word, word, length) == 0 && curr_word[length] == '\0')
+    {
+      return id;
+    }
+  }
+
+  return -1;
+}
+
+/*
+ * Get the tier of the first length letters of word
+ *
+ * RETURN (int tier)
+ * - -1 | The word is not in word set
+ */
+int wset_word_tier_get(wset_t* wset, const char* word, size_t length)
+{
+  int id = wset_word_id_get(wset, word, length);
+
+  if(id == -1) return -1;
+
+  return wset->tiers[id];
+}
+
+/*
+ * Check if the first length letters of word is a word in word set
+ *
+ * RETURN (bool does_exist)
+ */
+bool wset_word_exists(wset_t* wset, const char* word, size_t length)
+{
+  return (wset_word_id_get(wset, word, length) != -1);
+}
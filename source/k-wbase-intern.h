@@ -10,6 +10,8 @@
 #include <stdbool.h>
 #include <ctype.h>
 #include <string.h>
+#include <stdint.h>
+#include <pthread.h>
 
 #include "debug.h"
 
@@ -22,10 +24,127 @@ typedef struct node_t node_t;
 
 typedef struct node_t trie_t;
 
+/*
+ * Most nodes only have a few children, so only the children that exist
+ * are allocated, in the order of their letters. Bit index of letters
+ * is set if the node has a child with letter index
+ *
+ * The nodes of a minimized trie are shared by many parents,
+ * so a node is only freed when its last parent lets go of it
+ *
+ * The word of a node is tagged with the first tier that has it
+ */
 typedef struct node_t
 {
-  node_t* children[ALPHABET_SIZE];
-  bool    is_end_of_word;
+  node_t** children;
+  uint32_t letters;
+  uint32_t word_count;     // The words that end at or below the node
+  uint32_t refs;           // The parents sharing the node
+  bool     is_end_of_word;
+  uint8_t  tier;
 } node_t;
 
+/*
+ * Get the position in children of the child with letter index
+ */
+static inline int node_child_position(const node_t* node, int index)
+{
+  return __builtin_popcount(node->letters & ((1U << index) - 1));
+}
+
+/*
+ * Get the child of node with letter index
+ *
+ * RETURN (node_t* child)
+ * - NULL | The node has no child with the letter
+ */
+static inline node_t* node_child_get(const node_t* node, int index)
+{
+  if(!(node->letters & (1U << index))) return NULL;
+
+  return node->children[node_child_position(node, index)];
+}
+
+/*
+ * The words of a word set are stored after each other in letters,
+ * and every word has an id, which is the index of its offset and tier.
+ * The slots are open addressed and hold id + 1 of the words
+ */
+typedef struct wset_t
+{
+  char*     letters;
+  uint32_t* offsets;
+  uint8_t*  tiers;
+  uint32_t* slots;
+  size_t    count;
+  size_t    capacity;
+} wset_t;
+
+/*
+ * The words of a tier up to PACK_MAX_LENGTH letters,
+ * packed one letter per byte, see k-wbase-pack.c
+ */
+#define PACK_MAX_LENGTH 8
+
+typedef struct pack_t
+{
+  uint64_t* words[PACK_MAX_LENGTH + 1];
+  size_t    counts[PACK_MAX_LENGTH + 1];
+} pack_t;
+
+extern size_t pack_words_count(pack_t* pack, const char* pattern, size_t length, size_t max_amount);
+
+extern int    pack_words_search(char*** words, size_t* count, pack_t* pack, trie_t* used_trie, const char* pattern, size_t length);
+
+/*
+ * The nodes of a trie as states in a double array, see k-wbase-darray.c
+ */
+typedef struct darray_t
+{
+  int32_t*  bases;
+  int32_t*  checks;    // The parent of every state, -1 if the state is free
+  uint32_t* letters;   // Bit index is set if the state has a child with letter index
+  bool*     is_ends;
+  uint8_t*  tiers;
+  size_t    size;
+} darray_t;
+
+extern int  darray_span_words_exist(darray_t* darray, trie_t* used_trie, const char* line, const bool* is_stop, int stop_length, int max_amount);
+
+extern bool darray_span_word_exists(darray_t* darray, const char* line, const bool* is_stop, int stop_length);
+
+/*
+ * A word base that is changed while it is searched, see k-wbase-live.c
+ *
+ * The readers only touch wbase, the rest belongs to the writers
+ */
+typedef struct live_t
+{
+  wbase_t*        wbase;          // The newest word base, swapped atomically
+  trie_t*         trie;           // The words of the next word base, not minimized
+  trie_t*         rev_trie;       // The same words reversed, not minimized
+  size_t          count;          // The number of tiers
+  int             max_length;     // Longer words are not added
+  bool            is_changed;     // The trie has changes that are not swapped in
+  wbase_t**       retired;        // Old word bases that readers might still hold
+  size_t          retired_count;
+  pthread_mutex_t lock;
+} live_t;
+
+/*
+ * The kinds of queries that are remembered, see k-wbase-cache.c
+ */
+typedef enum query_kind_t
+{
+  QUERY_SPAN_COUNT,
+  QUERY_SPAN_EXISTS,
+  QUERY_REV_SPAN_EXISTS
+} query_kind_t;
+
+typedef struct wbase_t wbase_t;
+
+extern bool query_cache_get(int* amount, wbase_t* wbase, uint64_t used_hash, int kind, const char* line, const bool* is_stop, int stop_length, int max_amount);
+
+extern void query_cache_set(wbase_t* wbase, uint64_t used_hash, int kind, const char* line, const bool* is_stop, int stop_length, int amount, int max_amount);
+
 #endif // K_WBASE_INTERN_H
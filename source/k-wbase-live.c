@@ -0,0 +1,369 @@
+/*
+ * k-wbase-live.c - add and remove words of a running word base
+ *
+ * A word base is never changed while it is searched. Instead, the
+ * words are changed in a copy of its trie and reversed trie, and a new
+ * word base is built of the copies and swapped in. A reader holds the
+ * word base it searches, and gets the new word base the next time it holds one
+ *
+ * The reversed trie is the slowest part of a word base to build,
+ * so it is kept up to date word by word. The word set and the
+ * packed words are built again of the new trie every time
+ *
+ * Every reader thread has a hazard slot, with the word base it holds.
+ * An old word base is only freed when no slot has it,
+ * so the readers never have to wait for the writers
+ */
+
+#include "k-wbase.h"
+#include "k-wbase-intern.h"
+
+// __builtin_clzll counts the leading zeros, so the bit length is:
+#define CAPACITY(n) (1ULL << (64 - __builtin_clzll(n)))
+
+/*
+ * The max number of threads holding live word bases
+ */
+#define LIVE_MAX_READERS 256
+
+static wbase_t* hazards[LIVE_MAX_READERS];
+
+static int hazard_count = 0;
+
+static __thread int hazard_index = -1;
+
+/*
+ * The version is bumped every time a word base is swapped in
+ *
+ * A new word base can have the address of a freed word base,
+ * so a reader forgets its remembered answers when the version changes
+ */
+static uint64_t live_version = 0;
+
+static __thread uint64_t held_version = 0;
+
+/*
+ * Check if any reader holds wbase
+ */
+static bool wbase_is_held(wbase_t* wbase)
+{
+  int count = MIN(__atomic_load_n(&hazard_count, __ATOMIC_SEQ_CST), LIVE_MAX_READERS);
+
+  for(int index = 0; index < count; index++)
+  {
+    if(__atomic_load_n(&hazards[index], __ATOMIC_SEQ_CST) == wbase) return true;
+  }
+
+  return false;
+}
+
+/*
+ * Free the old word bases that no reader holds
+ */
+static void live_retired_free(live_t* live)
+{
+  size_t count = 0;
+
+  for(size_t index = 0; index < live->retired_count; index++)
+  {
+    wbase_t* wbase = live->retired[index];
+
+    if(wbase_is_held(wbase))
+    {
+      live->retired[count++] = wbase;
+    }
+    else wbase_free(&wbase);
+  }
+
+  live->retired_count = count;
+}
+
+/*
+ * Create live word base of wbase
+ *
+ * The live word base takes wbase and trie,
+ * which are freed with the live word base
+ *
+ * PARAMS
+ * - wbase_t* wbase | The first word base
+ * - trie_t* trie   | A copy of the words of wbase, not minimized
+ * - int max_length | Longer words are not added
+ *
+ * RETURN (live_t* live)
+ * - NULL | Bad input or failed to allocate
+ */
+live_t* live_create(wbase_t* wbase, trie_t* trie, int max_length)
+{
+  live_t* live = (wbase && trie) ? calloc(1, sizeof(live_t)) : NULL;
+
+  trie_t* rev_trie = live ? trie_reverse(trie) : NULL;
+
+  if(!rev_trie)
+  {
+    free(live);
+
+    wbase_free(&wbase);
+
+    trie_free(&trie);
+
+    return NULL;
+  }
+
+  live->wbase      = wbase;
+  live->trie       = trie;
+  live->rev_trie   = rev_trie;
+  live->count      = wbase->count;
+  live->max_length = max_length;
+
+  pthread_mutex_init(&live->lock, NULL);
+
+  return live;
+}
+
+/*
+ * Free live word base struct
+ *
+ * EXPECTS:
+ * - no reader holds a word base of live
+ */
+void live_free(live_t** live)
+{
+  if(!live || !(*live)) return;
+
+  for(size_t index = 0; index < (*live)->retired_count; index++)
+  {
+    wbase_free(&(*live)->retired[index]);
+  }
+
+  free((*live)->retired);
+
+  wbase_free(&(*live)->wbase);
+
+  trie_free(&(*live)->trie);
+
+  trie_free(&(*live)->rev_trie);
+
+  pthread_mutex_destroy(&(*live)->lock);
+
+  free(*live);
+
+  *live = NULL;
+}
+
+/*
+ * Hold the newest word base of live
+ *
+ * The word base is not freed until it is released,
+ * and a reader only holds one word base at a time
+ *
+ * RETURN (wbase_t* wbase)
+ * - NULL | Too many readers
+ */
+wbase_t* live_wbase_hold(live_t* live)
+{
+  if(hazard_index == -1)
+  {
+    int index = __atomic_fetch_add(&hazard_count, 1, __ATOMIC_SEQ_CST);
+
+    if(index >= LIVE_MAX_READERS) return NULL;
+
+    hazard_index = index;
+  }
+
+  // If a new word base was swapped in before the slot was set,
+  // the old word base might already be freed
+  wbase_t* wbase;
+
+  do
+  {
+    wbase = __atomic_load_n(&live->wbase, __ATOMIC_SEQ_CST);
+
+    __atomic_store_n(&hazards[hazard_index], wbase, __ATOMIC_SEQ_CST);
+  }
+  while(wbase != __atomic_load_n(&live->wbase, __ATOMIC_SEQ_CST));
+
+  uint64_t version = __atomic_load_n(&live_version, __ATOMIC_SEQ_CST);
+
+  if(version != held_version)
+  {
+    wbase_cache_clear();
+
+    held_version = version;
+  }
+
+  return wbase;
+}
+
+/*
+ * Release the word base that the calling thread holds
+ */
+void live_wbase_release(void)
+{
+  if(hazard_index == -1 || hazard_index >= LIVE_MAX_READERS) return;
+
+  __atomic_store_n(&hazards[hazard_index], NULL, __ATOMIC_SEQ_CST);
+}
+
+/*
+ * Check if every letter of word is in the alphabet
+ */
+static bool word_is_valid(const char* word)
+{
+  if(*word == '\0') return false;
+
+  for(; *word; word++)
+  {
+    if(letter_index_get(*word) == -1) return false;
+  }
+
+  return true;
+}
+
+/*
+ * Reverse word into rev_word
+ */
+static void word_reverse(char* rev_word, const char* word, size_t length)
+{
+  for(size_t index = 0; index < length; index++)
+  {
+    rev_word[index] = word[length - 1 - index];
+  }
+
+  rev_word[length] = '\0';
+}
+
+/*
+ * Add word to the next word base of live, tagged with tier
+ *
+ * The word is searched when the changes are swapped in
+ *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | Bad word or failed to allocate
+ */
+int live_word_add(live_t* live, const char* word, int tier)
+{
+  if(!live || !word) return 1;
+
+  size_t length = strlen(word);
+
+  if(length > (size_t) live->max_length || !word_is_valid(word)) return 1;
+
+  char rev_word[length + 1];
+
+  word_reverse(rev_word, word, length);
+
+  pthread_mutex_lock(&live->lock);
+
+  bool is_new = !trie_word_exists(live->trie, word);
+
+  int status = trie_word_tier_insert(live->trie, word, tier);
+
+  // Without the reversed word, the tries would be out of sync
+  if(status == 0 && trie_word_tier_insert(live->rev_trie, rev_word, tier) != 0)
+  {
+    if(is_new) trie_word_remove(live->trie, word);
+
+    status = 1;
+  }
+
+  if(status == 0) live->is_changed = true;
+
+  pthread_mutex_unlock(&live->lock);
+
+  return status;
+}
+
+/*
+ * Remove word from the next word base of live
+ *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | The word is not in live
+ */
+int live_word_remove(live_t* live, const char* word)
+{
+  if(!live || !word) return 1;
+
+  size_t length = strlen(word);
+
+  char rev_word[length + 1];
+
+  word_reverse(rev_word, word, length);
+
+  pthread_mutex_lock(&live->lock);
+
+  int status = 1;
+
+  if(trie_word_exists(live->trie, word))
+  {
+    trie_word_remove(live->trie, word);
+
+    trie_word_remove(live->rev_trie, rev_word);
+
+    live->is_changed = true;
+
+    status = 0;
+  }
+
+  pthread_mutex_unlock(&live->lock);
+
+  return status;
+}
+
+/*
+ * Swap in a new word base with the changed words of live
+ *
+ * The old word base is freed when no reader holds it.
+ * Without changes, only the old word bases are freed
+ *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | Failed to build word base
+ */
+int live_publish(live_t* live)
+{
+  if(!live) return 1;
+
+  pthread_mutex_lock(&live->lock);
+
+  int status = 0;
+
+  if(live->is_changed)
+  {
+    // 1. Build the new word base of a copy of the words
+    wbase_t* wbase = wbase_tries_build(trie_dup(live->trie), trie_dup(live->rev_trie), live->count);
+
+    size_t count = live->retired_count;
+
+    if(wbase && (count == 0 || (count + 1) >= CAPACITY(count)))
+    {
+      wbase_t** new_retired = realloc(live->retired, sizeof(wbase_t*) * CAPACITY(count + 1));
+
+      if(new_retired) live->retired = new_retired;
+
+      else wbase_free(&wbase);
+    }
+
+    // 2. Swap in the new word base, and retire the old
+    if(wbase)
+    {
+      wbase_t* old_wbase = __atomic_exchange_n(&live->wbase, wbase, __ATOMIC_SEQ_CST);
+
+      __atomic_fetch_add(&live_version, 1, __ATOMIC_SEQ_CST);
+
+      live->retired[live->retired_count++] = old_wbase;
+
+      live->is_changed = false;
+
+      info_print("Swapped in live words");
+    }
+    else status = 1;
+  }
+
+  live_retired_free(live);
+
+  pthread_mutex_unlock(&live->lock);
+
+  return status;
+}
@@ -0,0 +1,321 @@
+/*
+ * k-wbase-pack.c - match short words against patterns in bulk
+ *
+ * The short words of a tier are also packed into one 64-bit integer
+ * each, with one letter per byte, and sorted into arrays by length.
+ * A pattern becomes a mask of its known letters and the values of
+ * them, so a word matches if (word & mask) == value. With AVX2,
+ * four words are compared at a time
+ *
+ * The words are packed in the order of the trie,
+ * so a search gives the words in the same order as the trie
+ */
+
+#include "k-wbase.h"
+#include "k-wbase-intern.h"
+
+#include <immintrin.h>
+
+// __builtin_clzll counts the leading zeros, so the bit length is:
+#define CAPACITY(n) (1ULL << (64 - __builtin_clzll(n)))
+
+/*
+ * Append packed word to the array of its length
+ *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | Failed to allocate memory
+ */
+static int pack_word_append(pack_t* pack, uint64_t word, int length)
+{
+  size_t count = pack->counts[length];
+
+  if(count == 0 || (count + 1) >= CAPACITY(count))
+  {
+    uint64_t* new_words = realloc(pack->words[length], sizeof(uint64_t) * CAPACITY(count + 1));
+
+    if(!new_words) return 1;
+
+    pack->words[length] = new_words;
+  }
+
+  pack->words[length][pack->counts[length]++] = word;
+
+  return 0;
+}
+
+/*
+ * Pack every short word under node
+ *
+ * PARAMS
+ * - uint64_t word | The packed letters sience root
+ *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | Failed to allocate memory
+ */
+static int node_words_pack(pack_t* pack, node_t* node, uint64_t word, int length)
+{
+  if(node->is_end_of_word && length > 0)
+  {
+    if(pack_word_append(pack, word, length) != 0) return 1;
+  }
+
+  if(length >= PACK_MAX_LENGTH) return 0;
+
+  node_t** children = node->children;
+
+  // Only go through the allocated letters
+  for(uint32_t letters = node->letters; letters; letters &= (letters - 1))
+  {
+    int index = __builtin_ctz(letters);
+
+    node_t* child = *(children++);
+
+    uint64_t letter = (uint8_t) index_letter_get(index);
+
+    if(node_words_pack(pack, child, word | (letter << (8 * length)), length + 1) != 0)
+    {
+      return 1;
+    }
+  }
+
+  return 0;
+}
+
+/*
+ * Free pack struct
+ *
+ * After the struct is freed, the pointer is set to NULL
+ */
+void pack_free(pack_t** pack)
+{
+  if(!pack || !(*pack)) return;
+
+  for(int length = 0; length <= PACK_MAX_LENGTH; length++)
+  {
+    free((*pack)->words[length]);
+  }
+
+  free(*pack);
+
+  *pack = NULL;
+}
+
+/*
+ * Pack the short words of trie
+ *
+ * RETURN (pack_t* pack)
+ * - NULL | Bad input or failed to allocate
+ */
+pack_t* pack_create(trie_t* trie)
+{
+  if(!trie) return NULL;
+
+  pack_t* pack = calloc(1, sizeof(pack_t));
+
+  if(!pack) return NULL;
+
+  if(node_words_pack(pack, (node_t*) trie, 0, 0) != 0)
+  {
+    pack_free(&pack);
+
+    return NULL;
+  }
+
+  return pack;
+}
+
+/*
+ * Convert pattern to the mask and values of its letters
+ */
+static void pattern_pack(uint64_t* mask, uint64_t* value, const char* pattern, size_t length)
+{
+  *mask  = 0;
+  *value = 0;
+
+  for(size_t index = 0; index < length; index++)
+  {
+    if(letter_index_get(pattern[index]) == -1) continue;
+
+    *mask  |= (0xFFULL << (8 * index));
+    *value |= ((uint64_t) (uint8_t) pattern[index] << (8 * index));
+  }
+}
+
+/*
+ * Match words against mask and value
+ *
+ * If ids is NULL, the words are only counted
+ *
+ * RETURN (size_t amount)
+ * - max | max_amount
+ */
+typedef size_t (*pack_match_t)(size_t* ids, const uint64_t* words, size_t count, uint64_t mask, uint64_t value, size_t max_amount);
+
+static size_t pack_match_scalar(size_t* ids, const uint64_t* words, size_t count, uint64_t mask, uint64_t value, size_t max_amount)
+{
+  size_t amount = 0;
+
+  for(size_t index = 0; index < count && amount < max_amount; index++)
+  {
+    if((words[index] & mask) != value) continue;
+
+    if(ids) ids[amount] = index;
+
+    amount++;
+  }
+
+  return amount;
+}
+
+__attribute__((target("avx2")))
+static size_t pack_match_avx2(size_t* ids, const uint64_t* words, size_t count, uint64_t mask, uint64_t value, size_t max_amount)
+{
+  __m256i masks  = _mm256_set1_epi64x(mask);
+  __m256i values = _mm256_set1_epi64x(value);
+
+  size_t amount = 0;
+
+  size_t index = 0;
+
+  for(; (index + 4) <= count && amount < max_amount; index += 4)
+  {
+    __m256i block = _mm256_loadu_si256((const __m256i*) (words + index));
+
+    __m256i equal = _mm256_cmpeq_epi64(_mm256_and_si256(block, masks), values);
+
+    unsigned matches = _mm256_movemask_pd(_mm256_castsi256_pd(equal));
+
+    if(!ids)
+    {
+      amount += __builtin_popcount(matches);
+
+      continue;
+    }
+
+    for(; matches && amount < max_amount; matches &= (matches - 1))
+    {
+      ids[amount++] = index + __builtin_ctz(matches);
+    }
+  }
+
+  // The last words that don't fill a block
+  if(amount < max_amount)
+  {
+    size_t* rest_ids = ids ? (ids + amount) : NULL;
+
+    size_t rest_amount = pack_match_scalar(rest_ids, words + index, count - index, mask, value, max_amount - amount);
+
+    for(size_t rest = 0; rest_ids && rest < rest_amount; rest++)
+    {
+      rest_ids[rest] += index;
+    }
+
+    amount += rest_amount;
+  }
+
+  return MIN(amount, max_amount);
+}
+
+static pthread_once_t pack_match_once = PTHREAD_ONCE_INIT;
+
+static pack_match_t pack_match = pack_match_scalar;
+
+/*
+ * Pick the fastest match function the processor supports
+ */
+static void pack_match_pick(void)
+{
+  __builtin_cpu_init();
+
+  if(__builtin_cpu_supports("avx2")) pack_match = pack_match_avx2;
+}
+
+/*
+ * Count the words of pack that match pattern
+ *
+ * EXPECTS:
+ * - the length of pattern is at most PACK_MAX_LENGTH
+ *
+ * RETURN (size_t amount)
+ * - max | max_amount
+ */
+size_t pack_words_count(pack_t* pack, const char* pattern, size_t length, size_t max_amount)
+{
+  pthread_once(&pack_match_once, pack_match_pick);
+
+  uint64_t mask, value;
+
+  pattern_pack(&mask, &value, pattern, length);
+
+  return pack_match(NULL, pack->words[length], pack->counts[length], mask, value, max_amount);
+}
+
+/*
+ * Search the words of pack that match pattern
+ *
+ * Used words are not searched
+ *
+ * EXPECTS:
+ * - the length of pattern is at most PACK_MAX_LENGTH
+ *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | Failed to allocate memory
+ */
+int pack_words_search(char*** words, size_t* count, pack_t* pack, trie_t* used_trie, const char* pattern, size_t length)
+{
+  pthread_once(&pack_match_once, pack_match_pick);
+
+  uint64_t mask, value;
+
+  pattern_pack(&mask, &value, pattern, length);
+
+  size_t word_count = pack->counts[length];
+
+  if(word_count == 0) return 0;
+
+  size_t* ids = malloc(sizeof(size_t) * word_count);
+
+  if(!ids) return 1;
+
+  size_t amount = pack_match(ids, pack->words[length], word_count, mask, value, word_count);
+
+  int status = 0;
+
+  for(size_t index = 0; index < amount; index++)
+  {
+    uint64_t packed = pack->words[length][ids[index]];
+
+    char word[PACK_MAX_LENGTH + 1];
+
+    for(size_t letter = 0; letter < length; letter++)
+    {
+      word[letter] = (char) (packed >> (8 * letter));
+    }
+
+    word[length] = '\0';
+
+    if(used_trie && trie_word_exists(used_trie, word)) continue;
+
+    if(*count == 0 || ((*count) + 1) >= CAPACITY(*count))
+    {
+      char** new_words = realloc(*words, sizeof(char*) * CAPACITY((*count) + 1));
+
+      if(!new_words)
+      {
+        status = 1;
+        break;
+      }
+
+      *words = new_words;
+    }
+
+    (*words)[(*count)++] = strdup(word);
+  }
+
+  free(ids);
+
+  return status;
+}
@@ -9,6 +9,8 @@
 
 #include "k-intern.h"
 
+#include <unistd.h>
+
 extern int MAX_WORD_LENGTH;
 
 /*
@@ -18,9 +20,19 @@ static node_t* node_create(void)
 {
   node_t* node = malloc(sizeof(node_t));
 
+  if(!node) return NULL;
+
   node->is_end_of_word = false;
 
-  memset(node->children, 0, sizeof(node_t*) * ALPHABET_SIZE);
+  node->tier = 0;
+
+  node->children = NULL;
+
+  node->letters = 0;
+
+  node->word_count = 0;
+
+  node->refs = 1;
 
   return node;
 }
@@ -34,11 +46,23 @@ static void node_free(node_t** node)
 {
   if(!node || !(*node)) return;
 
-  for(int index = 0; index < ALPHABET_SIZE; index++)
+  // The node is still shared by other parents
+  if(--(*node)->refs > 0)
+  {
+    *node = NULL;
+
+    return;
+  }
+
+  int child_count = __builtin_popcount((*node)->letters);
+
+  for(int position = 0; position < child_count; position++)
   {
-    node_free((*node)->children + index);
+    node_free((*node)->children + position);
   }
 
+  free((*node)->children);
+
   free(*node);
 
   *node = NULL;
@@ -46,10 +70,91 @@ static void node_free(node_t** node)
 
 void trie_free(trie_t** trie) { node_free((node_t**) trie); }
 
+/*
+ * Add a blank child with letter index to node
+ *
+ * RETURN (node_t* child)
+ * - NULL | Failed to allocate memory
+ */
+static node_t* node_child_add(node_t* node, int index)
+{
+  int child_count = __builtin_popcount(node->letters);
+
+  node_t** new_children = realloc(node->children, sizeof(node_t*) * (child_count + 1));
+
+  if(!new_children) return NULL;
+
+  node->children = new_children;
+
+  node_t* child = node_create();
+
+  if(!child) return NULL;
+
+  int position = node_child_position(node, index);
+
+  // Make room for the child, to keep the children in letter order
+  memmove(node->children + position + 1, node->children + position, sizeof(node_t*) * (child_count - position));
+
+  node->children[position] = child;
+
+  node->letters |= (1U << index);
+
+  return child;
+}
+
+/*
+ * Remove the child with letter index from node
+ */
+static void node_child_remove(node_t* node, int index)
+{
+  if(!(node->letters & (1U << index))) return;
+
+  int child_count = __builtin_popcount(node->letters);
+
+  int position = node_child_position(node, index);
+
+  node_free(node->children + position);
+
+  memmove(node->children + position, node->children + position + 1, sizeof(node_t*) * (child_count - position - 1));
+
+  node->letters &= ~(1U << index);
+
+  if(node->letters == 0)
+  {
+    free(node->children);
+
+    node->children = NULL;
+  }
+}
+
+/*
+ * Add delta to the word count of every node in the path of word
+ *
+ * EXPECTS:
+ * - every letter of word has a node
+ */
+static void word_path_count_add(node_t* node, const char* word, int delta)
+{
+  node->word_count += delta;
+
+  for(int index = 0; word[index] != '\0'; index++)
+  {
+    node = node_child_get(node, letter_index_get(word[index]));
+
+    node->word_count += delta;
+  }
+}
+
 /*
  * Insert word in trie
+ *
+ * EXPECTS:
+ * - trie is not minimized
+ *
+ * RETURN (node_t* node)
+ * - NULL | The word has a non letter or failed to allocate
  */
-void trie_word_insert(trie_t* trie, const char* word)
+static node_t* word_node_insert(trie_t* trie, const char* word)
 {
   node_t* node = (node_t*) trie;
 
@@ -57,28 +162,100 @@ void trie_word_insert(trie_t* trie, const char* word)
   {
     int child_index = letter_index_get(word[index]);
 
-    if(child_index == -1) return;
+    if(child_index == -1) return NULL;
 
+    node_t* child = node_child_get(node, child_index);
 
-    if(!node->children[child_index])
+    if(!child)
     {
-      node->children[child_index] = node_create();
+      child = node_child_add(node, child_index);
+
+      if(!child) return NULL;
     }
 
-    node = node->children[child_index];
+    node = child;
   }
 
+  if(node->is_end_of_word) return node;
+
   node->is_end_of_word = true;
+
+  word_path_count_add((node_t*) trie, word, +1);
+
+  return node;
+}
+
+void trie_word_insert(trie_t* trie, const char* word)
+{
+  word_node_insert(trie, word);
+}
+
+/*
+ * Insert word in trie, tagged with tier
+ *
+ * A word that trie already has keeps the lowest tier
+ *
+ * EXPECTS:
+ * - trie is not minimized
+ *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | Bad input, the word has a non letter or failed to allocate
+ */
+int trie_word_tier_insert(trie_t* trie, const char* word, int tier)
+{
+  if(!trie || !word) return 1;
+
+  bool is_new = !trie_word_exists(trie, word);
+
+  node_t* node = word_node_insert(trie, word);
+
+  if(!node) return 1;
+
+  node->tier = is_new ? tier : MIN(node->tier, tier);
+
+  return 0;
+}
+
+/*
+ * Check if word is in trie
+ *
+ * RETURN (bool does_exist)
+ */
+bool trie_word_exists(trie_t* trie, const char* word)
+{
+  if (!trie || !word) return false;
+
+  node_t* node = (node_t*) trie;
+
+  for (int index = 0; word[index] != '\0'; index++)
+  {
+    int child_index = letter_index_get(word[index]);
+
+    if (child_index == -1) return false;
+
+    node = node_child_get(node, child_index);
+
+    if (!node) return false;
+  }
+
+  return node->is_end_of_word;
 }
 
 /*
  * Remove word from trie
+ *
+ * EXPECTS:
+ * - trie is not minimized
  */
 void trie_word_remove(trie_t* trie, const char* word)
 {
   if (!trie || !word) return;
 
-  node_t** node = (node_t**) &trie;
+  node_t* parent = NULL;
+  node_t* node   = (node_t*) trie;
+
+  int last_index = -1;
 
   for (int index = 0; word[index] != '\0'; index++)
   {
@@ -86,29 +263,29 @@ void trie_word_remove(trie_t* trie, const char* word)
 
     if (child_index == -1) return;
 
-    node = &(*node)->children[child_index];
+    parent = node;
+
+    node = node_child_get(node, child_index);
 
     // If a letter node is missing, the word isn't in trie
-    if (!node || !(*node))
-    {
-      return;
-    }
+    if (!node) return;
+
+    last_index = child_index;
   }
 
-  if ((*node) != trie)
+  if (parent)
   {
-    (*node)->is_end_of_word = false;
-
-    // Free node if it has no children
-    for (int index = 0; index < ALPHABET_SIZE; index++)
+    if (node->is_end_of_word)
     {
-      if ((*node)->children[index])
-      {
-        return;
-      }
+      word_path_count_add((node_t*) trie, word, -1);
     }
 
-    node_free(node);
+    node->is_end_of_word = false;
+
+    // Free node if it has no children
+    if (node->letters != 0) return;
+
+    node_child_remove(parent, last_index);
   }
 }
 
@@ -128,111 +305,1263 @@ static char* string_lower(char* string)
 }
 
 /*
- * Load words from file and create trie struct
+ * The size of the buffer that word files are read through
+ */
+#define LOAD_BUFFER_SIZE 65536
+
+/*
+ * The path of the last inserted word, from the root
  *
- * PARAMS
- * - const char* wfile | Word file
+ * The words of a sorted word file share a prefix with the word
+ * before them, so only the letters after the prefix are inserted
  *
- * RETURN (trie_t* trie)
- * - NULL | Failed to read file
+ * This struct is only used by these internal functions
  */
-trie_t* trie_load(char* wfile)
+typedef struct builder_t
 {
-  if(!wfile) return NULL;
+  node_t** path;     // path[index] is the node after index letters
+  char*    word;     // The letters of the path
+  int      length;   // The number of letters in the path
+} builder_t;
 
-  char words_file[1024];
+/*
+ * Insert word in trie, from the prefix it shares with the last word
+ *
+ * RETURN (int status)
+ * - 0 | Success, or the word has a non letter
+ * - 1 | Failed to allocate memory
+ */
+static int builder_word_insert(builder_t* builder, const char* word, int length)
+{
+  // 1. Find the prefix that word shares with the last word
+  int prefix = 0;
 
-  if (words_file_get(words_file, wfile) != 0)
+  while(prefix < builder->length && prefix < length && builder->word[prefix] == word[prefix])
   {
-    return NULL;
+    prefix++;
   }
 
-  size_t file_size = file_size_get(words_file);
+  // 2. Insert the letters after the prefix
+  node_t* node = builder->path[prefix];
 
-  char* buffer = malloc(sizeof(char) * (file_size + 1));
-
-  if(file_read(buffer, file_size, words_file) == 0)
+  for(int index = prefix; index < length; index++)
   {
-    return NULL;
-  }
-
-  buffer[file_size] = '\0';
-
-
-  trie_t* trie = trie_create();
+    int child_index = letter_index_get(word[index]);
 
-  size_t count = 0;
+    // The path is kept up to the non letter
+    if(child_index == -1)
+    {
+      builder->length = index;
 
-  char* token = strtok(buffer, "\n");
+      return 0;
+    }
 
-  while(token)
-  {
-    char* word = string_lower(strdup(token));
+    node_t* child = node_child_get(node, child_index);
 
-    if(strlen(word) <= MAX_WORD_LENGTH)
+    if(!child)
     {
-      count++;
+      child = node_child_add(node, child_index);
 
-      trie_word_insert(trie, word);
+      if(!child)
+      {
+        builder->length = index;
+
+        return 1;
+      }
     }
 
-    free(word);
+    builder->word[index] = word[index];
+
+    builder->path[index + 1] = child;
 
-    token = strtok(NULL, "\n");
+    node = child;
   }
 
-  free(buffer);
+  builder->length = length;
 
-  return trie;
+  if(node->is_end_of_word) return 0;
+
+  node->is_end_of_word = true;
+
+  // 3. Count the word in every node of the path
+  for(int index = 0; index <= length; index++)
+  {
+    builder->path[index]->word_count++;
+  }
+
+  return 0;
 }
 
 /*
- * Duplicate trie node
+ * The size of the ranges of words that are handed to the workers
  *
- * RETURN (node_t* dup)
- * - allocated node_t struct
+ * A range only has words of one first letter, and one range of
+ * every letter is filled at a time. A letter with more words
+ * than fit in one range is split over many
  */
-static node_t* node_dup(node_t* node)
+#define LOAD_RANGE_SIZE 65536
+
+/*
+ * Words of one first letter, each ended by '\0'
+ *
+ * This struct is only used by these internal functions
+ */
+typedef struct range_t
 {
-  if(!node) return NULL;
+  char*           words;
+  size_t          size;   // The number of used bytes of words
+  int             letter;
+  struct range_t* next;
+} range_t;
 
-  node_t* dup = malloc(sizeof(node_t));
+/*
+ * The ranges that are read but not yet built,
+ * and the sub-trie of every first letter
+ *
+ * The sub-trie of a letter is only built by one worker at a time,
+ * so the ranges of a letter in an unsorted file take turns
+ *
+ * This struct is only used by these internal functions
+ */
+typedef struct load_t
+{
+  trie_t*         tries[ALPHABET_SIZE];
+  bool            is_busy[ALPHABET_SIZE]; // A worker is building the sub-trie of the letter
+  range_t*        ranges;                 // The ranges in the order they were read
+  range_t**       range_tail;
+  size_t          range_count;
+  int             max_length;
+  bool            is_read;                // Every range has been pushed
+  bool            is_failed;
+  pthread_t       workers[ALPHABET_SIZE];
+  long            worker_count;
+  pthread_mutex_t lock;
+  pthread_cond_t  cond;
+} load_t;
 
-  dup->is_end_of_word = node->is_end_of_word;
+/*
+ * Create a blank range of words with first letter
+ *
+ * RETURN (range_t* range)
+ * - NULL | Failed to allocate memory
+ */
+static range_t* range_create(int letter, int max_length)
+{
+  range_t* range = malloc(sizeof(range_t));
+
+  if(!range) return NULL;
 
-  for(int index = 0; index < ALPHABET_SIZE; index++)
+  // A word longer than the range still has to fit
+  range->words = malloc(sizeof(char) * MAX(LOAD_RANGE_SIZE, max_length + 1));
+
+  if(!range->words)
   {
-    dup->children[index] = node_dup(node->children[index]);
+    free(range);
+
+    return NULL;
   }
 
-  return dup;
+  range->size = 0;
+
+  range->letter = letter;
+
+  range->next = NULL;
+
+  return range;
 }
 
-trie_t* trie_dup(trie_t* trie) { return node_dup((node_t*) trie); }
+/*
+ * Free range of words
+ */
+static void range_free(range_t** range)
+{
+  if(!range || !(*range)) return;
+
+  free((*range)->words);
+
+  free(*range);
+
+  *range = NULL;
+}
 
 /*
- * Copy trie node
+ * Check if loading has failed
  */
-static void node_copy(node_t** copy, node_t* node)
+static bool load_is_failed(load_t* load)
 {
-  if (!copy || !(*copy)) return;
+  pthread_mutex_lock(&load->lock);
 
-  if (!node)
+  bool is_failed = load->is_failed;
+
+  pthread_mutex_unlock(&load->lock);
+
+  return is_failed;
+}
+
+/*
+ * Mark loading as failed
+ *
+ * The reader stops reading, and the workers stop building
+ */
+static void load_fail(load_t* load)
+{
+  pthread_mutex_lock(&load->lock);
+
+  load->is_failed = true;
+
+  pthread_cond_broadcast(&load->cond);
+
+  pthread_mutex_unlock(&load->lock);
+}
+
+/*
+ * Build the words of range into the sub-trie of its letter
+ *
+ * EXPECTS:
+ * - no other worker is building the sub-trie of the letter
+ *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | Failed to allocate memory
+ */
+static int load_range_build(load_t* load, range_t* range)
+{
+  trie_t** trie = &load->tries[range->letter];
+
+  if(!(*trie) && !(*trie = trie_create())) return 1;
+
+  node_t* path[load->max_length + 1];
+
+  char word[load->max_length + 1];
+
+  builder_t builder = { .path = path, .word = word, .length = 0 };
+
+  path[0] = (node_t*) *trie;
+
+  for(size_t offset = 0; offset < range->size;)
   {
-    node_free(copy);
+    char* line = range->words + offset;
 
-    return;
+    int length = strlen(line);
+
+    if(builder_word_insert(&builder, line, length) != 0) return 1;
+
+    offset += length + 1;
   }
 
-  (*copy)->is_end_of_word = node->is_end_of_word;
+  return 0;
+}
 
-  for(int index = 0; index < ALPHABET_SIZE; index++)
+/*
+ * Take the first range whose sub-trie no worker is building
+ *
+ * EXPECTS:
+ * - load->lock is locked
+ *
+ * RETURN (range_t* range)
+ * - NULL | No range can be built right now
+ */
+static range_t* load_range_take(load_t* load)
+{
+  for(range_t** range = &load->ranges; *range; range = &(*range)->next)
   {
-    node_copy(&(*copy)->children[index], node->children[index]);
+    if(load->is_busy[(*range)->letter]) continue;
+
+    range_t* taken = *range;
+
+    *range = taken->next;
+
+    if(!(*range)) load->range_tail = range;
+
+    load->range_count--;
+
+    load->is_busy[taken->letter] = true;
+
+    return taken;
   }
+
+  return NULL;
 }
 
-void trie_copy(trie_t** copy, trie_t* trie)
+/*
+ * Routine of a load worker
+ *
+ * The worker builds the ranges it takes,
+ * until every range is read and built
+ */
+static void* load_routine(void* arg)
 {
-  node_copy((node_t**) copy, (node_t*) trie);
+  load_t* load = arg;
+
+  pthread_mutex_lock(&load->lock);
+
+  while(true)
+  {
+    range_t* range = load_range_take(load);
+
+    if(!range)
+    {
+      if(load->is_read && load->range_count == 0) break;
+
+      pthread_cond_wait(&load->cond, &load->lock);
+
+      continue;
+    }
+
+    pthread_mutex_unlock(&load->lock);
+
+    // After a failure, the ranges are only freed
+    if(!load_is_failed(load) && load_range_build(load, range) != 0)
+    {
+      load_fail(load);
+    }
+
+    pthread_mutex_lock(&load->lock);
+
+    load->is_busy[range->letter] = false;
+
+    range_free(&range);
+
+    // The reader might wait for room, and other workers for the letter
+    pthread_cond_broadcast(&load->cond);
+  }
+
+  pthread_mutex_unlock(&load->lock);
+
+  return NULL;
+}
+
+/*
+ * Hand range to the workers
+ *
+ * The reader waits while the workers are behind,
+ * so only a few ranges are in memory at once.
+ * Without workers, the range is built right away
+ *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | Loading has failed, and range is freed
+ */
+static int load_range_push(load_t* load, range_t* range)
+{
+  if(load->worker_count == 0)
+  {
+    if(!load->is_failed && load_range_build(load, range) != 0)
+    {
+      load->is_failed = true;
+    }
+
+    range_free(&range);
+
+    return load->is_failed ? 1 : 0;
+  }
+
+  pthread_mutex_lock(&load->lock);
+
+  while(load->range_count >= (size_t) (2 * load->worker_count) && !load->is_failed)
+  {
+    pthread_cond_wait(&load->cond, &load->lock);
+  }
+
+  if(load->is_failed)
+  {
+    pthread_mutex_unlock(&load->lock);
+
+    range_free(&range);
+
+    return 1;
+  }
+
+  *load->range_tail = range;
+
+  load->range_tail = &range->next;
+
+  load->range_count++;
+
+  pthread_cond_signal(&load->cond);
+
+  pthread_mutex_unlock(&load->lock);
+
+  return 0;
+}
+
+/*
+ * Start a pool of load workers, one per processor
+ *
+ * With one processor, no worker is started, because
+ * the workers would only take turns with the reader
+ */
+static void load_workers_start(load_t* load)
+{
+  pthread_mutex_init(&load->lock, NULL);
+
+  pthread_cond_init(&load->cond, NULL);
+
+  long worker_count = MIN(sysconf(_SC_NPROCESSORS_ONLN), ALPHABET_SIZE);
+
+  load->worker_count = 0;
+
+  for(; worker_count > 1 && load->worker_count < worker_count; load->worker_count++)
+  {
+    if(pthread_create(&load->workers[load->worker_count], NULL, load_routine, load) != 0) break;
+  }
+}
+
+/*
+ * Let the workers build the last ranges, and wait for them
+ */
+static void load_workers_join(load_t* load)
+{
+  pthread_mutex_lock(&load->lock);
+
+  load->is_read = true;
+
+  pthread_cond_broadcast(&load->cond);
+
+  pthread_mutex_unlock(&load->lock);
+
+  for(long index = 0; index < load->worker_count; index++)
+  {
+    pthread_join(load->workers[index], NULL);
+  }
+
+  pthread_cond_destroy(&load->cond);
+
+  pthread_mutex_destroy(&load->lock);
+}
+
+/*
+ * Stitch the sub-tries of every letter under one root
+ *
+ * The roots of the sub-tries are freed
+ *
+ * RETURN (trie_t* trie)
+ * - NULL | Failed to allocate memory
+ */
+static trie_t* load_tries_stitch(load_t* load)
+{
+  node_t* root = trie_create();
+
+  if(!root) return NULL;
+
+  root->children = malloc(sizeof(node_t*) * ALPHABET_SIZE);
+
+  if(!root->children)
+  {
+    trie_free(&root);
+
+    return NULL;
+  }
+
+  for(int letter = 0; letter < ALPHABET_SIZE; letter++)
+  {
+    node_t* sub_root = (node_t*) load->tries[letter];
+
+    if(!sub_root) continue;
+
+    node_t* child = node_child_get(sub_root, letter);
+
+    if(child)
+    {
+      root->children[__builtin_popcount(root->letters)] = child;
+
+      root->letters |= (1U << letter);
+
+      root->word_count += child->word_count;
+    }
+
+    // The child is not freed, because it is moved to root
+    free(sub_root->children);
+
+    free(sub_root);
+
+    load->tries[letter] = NULL;
+  }
+
+  if(root->letters == 0)
+  {
+    free(root->children);
+
+    root->children = NULL;
+  }
+
+  return root;
+}
+
+/*
+ * Load words from file and create trie struct
+ *
+ * The file is read line by line through a fixed buffer, and
+ * the words are handed to a pool of workers in ranges of one
+ * first letter. Every worker inserts a word from the prefix it
+ * shares with the word before it, which is most of a sorted word,
+ * into the sub-trie of the letter. At last, the sub-tries are
+ * stitched together under one root
+ *
+ * PARAMS
+ * - const char* wfile | Word file
+ * - int max_length    | Longer words are not loaded
+ *
+ * RETURN (trie_t* trie)
+ * - NULL | Failed to read file
+ */
+trie_t* trie_load(char* wfile, int max_length)
+{
+  if(!wfile) return NULL;
+
+  char words_file[1024];
+
+  if (words_file_get(words_file, wfile) != 0)
+  {
+    return NULL;
+  }
+
+  FILE* stream = fopen(words_file, "r");
+
+  if(!stream) return NULL;
+
+  setvbuf(stream, NULL, _IOFBF, LOAD_BUFFER_SIZE);
+
+  load_t load = { 0 };
+
+  load.max_length = MIN(max_length, MAX_WORD_LENGTH);
+
+  load.range_tail = &load.ranges;
+
+  // 1. Start the workers, that build the sub-tries of the ranges
+  load_workers_start(&load);
+
+  // 2. Read the file into ranges of one first letter
+  range_t* ranges[ALPHABET_SIZE] = { NULL };
+
+  // The line is reused for every line of the file
+  char*  line = NULL;
+  size_t size = 0;
+
+  ssize_t length;
+
+  while((length = getline(&line, &size, stream)) != -1)
+  {
+    if(length > 0 && line[length - 1] == '\n') line[--length] = '\0';
+
+    if(length == 0 || length > load.max_length) continue;
+
+    int letter = letter_index_get(*string_lower(line));
+
+    // The word would not be inserted anyway
+    if(letter == -1) continue;
+
+    range_t** range = &ranges[letter];
+
+    // The full range of the letter is handed over
+    if(*range && (*range)->size + length + 1 > LOAD_RANGE_SIZE)
+    {
+      int status = load_range_push(&load, *range);
+
+      *range = NULL;
+
+      if(status != 0) break;
+    }
+
+    if(!(*range) && !(*range = range_create(letter, load.max_length)))
+    {
+      load_fail(&load);
+
+      break;
+    }
+
+    memcpy((*range)->words + (*range)->size, line, length + 1);
+
+    (*range)->size += length + 1;
+  }
+
+  // The last ranges are handed over, or only freed after a failure
+  for(int letter = 0; letter < ALPHABET_SIZE; letter++)
+  {
+    if(ranges[letter]) load_range_push(&load, ranges[letter]);
+  }
+
+  free(line);
+
+  fclose(stream);
+
+  // 3. Wait for the workers, and stitch the sub-tries together
+  load_workers_join(&load);
+
+  trie_t* trie = NULL;
+
+  if(!load.is_failed)
+  {
+    trie = load_tries_stitch(&load);
+  }
+
+  for(int letter = 0; letter < ALPHABET_SIZE; letter++)
+  {
+    trie_free(&load.tries[letter]);
+  }
+
+  return trie;
+}
+
+/*
+ * This struct is only used by these internal functions
+ */
+typedef struct file_load_t
+{
+  char*   wfile;
+  int     max_length;
+  trie_t* trie;
+} file_load_t;
+
+/*
+ * Routine of a thread loading one word file
+ */
+static void* file_load_routine(void* arg)
+{
+  file_load_t* file_load = arg;
+
+  file_load->trie = trie_load(file_load->wfile, file_load->max_length);
+
+  return NULL;
+}
+
+/*
+ * Load the words of every word file at the same time
+ *
+ * The trie of a word file that failed to load is NULL
+ *
+ * PARAMS
+ * - trie_t** tries   | The trie of every word file
+ * - char** wfiles    | Word files
+ * - int* max_lengths | The longest words to load of every word file
+ * - size_t count     | Number of word files
+ */
+void tries_load(trie_t** tries, char** wfiles, const int* max_lengths, size_t count)
+{
+  if(!tries || !wfiles || !max_lengths || count == 0) return;
+
+  file_load_t file_loads[count];
+
+  pthread_t threads[count];
+
+  bool is_started[count];
+
+  // With one processor, the threads would only take turns
+  bool is_parallel = (count > 1 && sysconf(_SC_NPROCESSORS_ONLN) > 1);
+
+  for(size_t index = 0; index < count; index++)
+  {
+    file_loads[index] = (file_load_t)
+    {
+      .wfile      = wfiles[index],
+      .max_length = max_lengths[index],
+      .trie       = NULL
+    };
+
+    is_started[index] = is_parallel &&
+      (pthread_create(&threads[index], NULL, file_load_routine, &file_loads[index]) == 0);
+  }
+
+  for(size_t index = 0; index < count; index++)
+  {
+    // If no thread could be started, the file is loaded here
+    if(is_started[index])
+    {
+      pthread_join(threads[index], NULL);
+    }
+    else file_load_routine(&file_loads[index]);
+
+    tries[index] = file_loads[index].trie;
+  }
+}
+
+/*
+ * Remove the words under node that are longer than max_length
+ *
+ * The children without words left are removed
+ *
+ * RETURN (int amount)
+ * - The amount of words that were removed
+ */
+static int node_prune(node_t* node, int max_length)
+{
+  int amount = 0;
+
+  for(uint32_t letters = node->letters; letters; letters &= (letters - 1))
+  {
+    int index = __builtin_ctz(letters);
+
+    node_t* child = node_child_get(node, index);
+
+    if(max_length > 0)
+    {
+      amount += node_prune(child, max_length - 1);
+
+      if(child->word_count > 0) continue;
+    }
+    else amount += child->word_count;
+
+    node_child_remove(node, index);
+  }
+
+  node->word_count -= amount;
+
+  return amount;
+}
+
+/*
+ * Remove the words of trie that are longer than max_length
+ *
+ * EXPECTS:
+ * - trie is not minimized
+ */
+void trie_prune(trie_t* trie, int max_length)
+{
+  if(!trie) return;
+
+  node_prune((node_t*) trie, max_length);
+}
+
+/*
+ * Insert every word under node reversed into reversed trie
+ *
+ * PARAMS
+ * - char* word | Buffer of the letters sience root
+ */
+static void node_reverse(trie_t* reversed, node_t* node, char* word, int length)
+{
+  if(node->is_end_of_word)
+  {
+    char reversed_word[length + 1];
+
+    for(int index = 0; index < length; index++)
+    {
+      reversed_word[index] = word[length - 1 - index];
+    }
+
+    reversed_word[length] = '\0';
+
+    node_t* reversed_node = word_node_insert(reversed, reversed_word);
+
+    if(reversed_node) reversed_node->tier = node->tier;
+  }
+
+  // Words longer than MAX_WORD_LENGTH are never loaded
+  if(length >= MAX_WORD_LENGTH) return;
+
+  node_t** children = node->children;
+
+  for(uint32_t letters = node->letters; letters; letters &= (letters - 1))
+  {
+    node_t* child = *(children++);
+
+    word[length] = index_letter_get(__builtin_ctz(letters));
+
+    node_reverse(reversed, child, word, length + 1);
+  }
+}
+
+/*
+ * Create a trie with every word of trie reversed
+ *
+ * The reversed trie is used to search words backwards from their last letter
+ *
+ * RETURN (trie_t* reversed)
+ * - NULL | Bad input or failed to allocate
+ */
+trie_t* trie_reverse(trie_t* trie)
+{
+  if(!trie) return NULL;
+
+  trie_t* reversed = trie_create();
+
+  if(!reversed) return NULL;
+
+  char word[MAX_WORD_LENGTH + 1];
+
+  node_reverse(reversed, (node_t*) trie, word, 0);
+
+  return reversed;
+}
+
+/*
+ * Duplicate trie node
+ *
+ * RETURN (node_t* dup)
+ * - allocated node_t struct
+ */
+static node_t* node_dup(node_t* node)
+{
+  if(!node) return NULL;
+
+  node_t* dup = malloc(sizeof(node_t));
+
+  dup->is_end_of_word = node->is_end_of_word;
+
+  dup->tier = node->tier;
+
+  dup->letters = node->letters;
+
+  dup->word_count = node->word_count;
+
+  dup->refs = 1;
+
+  int child_count = __builtin_popcount(node->letters);
+
+  dup->children = (child_count > 0) ? malloc(sizeof(node_t*) * child_count) : NULL;
+
+  for(int position = 0; position < child_count; position++)
+  {
+    dup->children[position] = node_dup(node->children[position]);
+  }
+
+  return dup;
+}
+
+trie_t* trie_dup(trie_t* trie) { return node_dup((node_t*) trie); }
+
+/*
+ * Copy trie node
+ */
+static void node_copy(node_t** copy, node_t* node)
+{
+  if (!copy || !(*copy)) return;
+
+  if (!node)
+  {
+    node_free(copy);
+
+    return;
+  }
+
+  (*copy)->is_end_of_word = node->is_end_of_word;
+
+  (*copy)->tier = node->tier;
+
+  // Only the children that copy already has are copied
+  node_t** children = (*copy)->children;
+
+  for(uint32_t letters = (*copy)->letters; letters; letters &= (letters - 1))
+  {
+    int index = __builtin_ctz(letters);
+
+    node_t* child = node_child_get(node, index);
+
+    if(child)
+    {
+      node_copy(children++, child);
+    }
+    else node_child_remove(*copy, index);
+  }
+
+  // Count the words of the children that are left
+  (*copy)->word_count = (*copy)->is_end_of_word;
+
+  int child_count = __builtin_popcount((*copy)->letters);
+
+  for(int position = 0; position < child_count; position++)
+  {
+    (*copy)->word_count += (*copy)->children[position]->word_count;
+  }
+}
+
+void trie_copy(trie_t** copy, trie_t* trie)
+{
+  node_copy((node_t**) copy, (node_t*) trie);
+}
+
+/*
+ * The registry has one node of every distinct subtree.
+ * This struct is only used by these internal functions
+ */
+typedef struct registry_t
+{
+  node_t** slots;
+  size_t   count;
+  size_t   capacity;
+} registry_t;
+
+/*
+ * Hash the end mark, tier, letters and children of node (FNV-1a)
+ *
+ * The children are already minimized, so equal subtrees
+ * have the very same children
+ */
+static uint64_t node_hash(const node_t* node)
+{
+  uint64_t hash = 14695981039346656037ULL;
+
+  hash ^= node->is_end_of_word;
+  hash *= 1099511628211ULL;
+
+  hash ^= node->tier;
+  hash *= 1099511628211ULL;
+
+  hash ^= node->letters;
+  hash *= 1099511628211ULL;
+
+  int child_count = __builtin_popcount(node->letters);
+
+  for(int position = 0; position < child_count; position++)
+  {
+    hash ^= (uintptr_t) node->children[position];
+    hash *= 1099511628211ULL;
+  }
+
+  return hash;
+}
+
+/*
+ * Check if two nodes with minimized children are equal
+ *
+ * RETURN (bool is_equal)
+ */
+static bool nodes_are_equal(const node_t* node, const node_t* other)
+{
+  if(node->is_end_of_word != other->is_end_of_word) return false;
+
+  if(node->tier != other->tier) return false;
+
+  if(node->letters != other->letters) return false;
+
+  int child_count = __builtin_popcount(node->letters);
+
+  return (memcmp(node->children, other->children, sizeof(node_t*) * child_count) == 0);
+}
+
+/*
+ * Get the slot of node in registry
+ *
+ * The slot is either empty or has a node equal to node
+ */
+static node_t** registry_slot_get(registry_t* registry, const node_t* node)
+{
+  size_t mask = (registry->capacity - 1);
+
+  size_t slot = node_hash(node) & mask;
+
+  for(; registry->slots[slot]; slot = (slot + 1) & mask)
+  {
+    if(nodes_are_equal(registry->slots[slot], node)) break;
+  }
+
+  return &registry->slots[slot];
+}
+
+/*
+ * Double the capacity of registry
+ *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | Failed to allocate memory
+ */
+static int registry_grow(registry_t* registry)
+{
+  node_t** old_slots    = registry->slots;
+  size_t   old_capacity = registry->capacity;
+
+  node_t** new_slots = calloc(old_capacity * 2, sizeof(node_t*));
+
+  if(!new_slots) return 1;
+
+  registry->slots    = new_slots;
+  registry->capacity = old_capacity * 2;
+
+  for(size_t slot = 0; slot < old_capacity; slot++)
+  {
+    if(!old_slots[slot]) continue;
+
+    *registry_slot_get(registry, old_slots[slot]) = old_slots[slot];
+  }
+
+  free(old_slots);
+
+  return 0;
+}
+
+/*
+ * Minimize the children of node, and get the registered node equal to node
+ *
+ * If an equal node is already registered, node is freed
+ *
+ * RETURN (node_t* node)
+ * - NULL | Failed to allocate memory
+ */
+static node_t* node_minimize(registry_t* registry, node_t* node)
+{
+  int child_count = __builtin_popcount(node->letters);
+
+  for(int position = 0; position < child_count; position++)
+  {
+    node_t* child = node_minimize(registry, node->children[position]);
+
+    if(!child) return NULL;
+
+    node->children[position] = child;
+  }
+
+  // At most half of the slots are used
+  if((registry->count + 1) * 2 > registry->capacity)
+  {
+    if(registry_grow(registry) != 0) return NULL;
+  }
+
+  node_t** slot = registry_slot_get(registry, node);
+
+  if(*slot)
+  {
+    if(*slot == node) return node;
+
+    (*slot)->refs++;
+
+    node_free(&node);
+
+    return *slot;
+  }
+
+  *slot = node;
+
+  registry->count++;
+
+  return node;
+}
+
+/*
+ * Minimize trie into a directed acyclic word graph
+ *
+ * Equal subtrees, like the common endings of words, are merged into one.
+ * The words and the order of them are the same as before,
+ * but the trie can no longer be changed
+ *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | Bad input or failed to allocate
+ */
+int trie_minimize(trie_t* trie)
+{
+  if(!trie) return 1;
+
+  registry_t registry = { 0 };
+
+  registry.capacity = 1024;
+
+  registry.slots = calloc(registry.capacity, sizeof(node_t*));
+
+  if(!registry.slots) return 1;
+
+  int status = 0;
+
+  node_t* node = (node_t*) trie;
+
+  int child_count = __builtin_popcount(node->letters);
+
+  // The root itself is never merged
+  for(int position = 0; position < child_count; position++)
+  {
+    node_t* child = node_minimize(&registry, node->children[position]);
+
+    if(!child)
+    {
+      status = 1;
+      break;
+    }
+
+    node->children[position] = child;
+  }
+
+  free(registry.slots);
+
+  return status;
+}
+
+/*
+ * Get the id of word, which is the order it has in trie
+ *
+ * The ids are the same as the ids of a word set of trie
+ *
+ * RETURN (int id)
+ * - -1 | The word is not in trie
+ */
+int trie_word_id_get(trie_t* trie, const char* word)
+{
+  if(!trie || !word) return -1;
+
+  node_t* node = (node_t*) trie;
+
+  int id = 0;
+
+  for(int index = 0; word[index] != '\0'; index++)
+  {
+    int child_index = letter_index_get(word[index]);
+
+    if(child_index == -1) return -1;
+
+    node_t* child = node_child_get(node, child_index);
+
+    if(!child) return -1;
+
+    // The shorter word of the node comes before
+    id += node->is_end_of_word;
+
+    // The words of the earlier letters come before
+    int position = node_child_position(node, child_index);
+
+    for(int earlier = 0; earlier < position; earlier++)
+    {
+      id += node->children[earlier]->word_count;
+    }
+
+    node = child;
+  }
+
+  return node->is_end_of_word ? id : -1;
+}
+
+/*
+ * Get the tier of word in trie
+ *
+ * RETURN (int tier)
+ * - -1 | The word is not in trie
+ */
+int trie_word_tier_get(trie_t* trie, const char* word)
+{
+  if(!trie || !word) return -1;
+
+  node_t* node = (node_t*) trie;
+
+  for(int index = 0; word[index] != '\0'; index++)
+  {
+    int child_index = letter_index_get(word[index]);
+
+    if(child_index == -1) return -1;
+
+    node = node_child_get(node, child_index);
+
+    if(!node) return -1;
+  }
+
+  return node->is_end_of_word ? node->tier : -1;
+}
+
+/*
+ * Merge the words under node into merged node, tagged with tier
+ *
+ * The words that merged node already has keep the lowest tier
+ *
+ * RETURN (int amount)
+ * - -1 | Failed to allocate memory
+ * - The amount of words that were added
+ */
+static int node_merge(node_t* merged, node_t* node, int tier)
+{
+  int amount = 0;
+
+  if(node->is_end_of_word)
+  {
+    if(!merged->is_end_of_word)
+    {
+      merged->is_end_of_word = true;
+
+      merged->tier = tier;
+
+      amount++;
+    }
+    else merged->tier = MIN(merged->tier, tier);
+  }
+
+  node_t** children = node->children;
+
+  for(uint32_t letters = node->letters; letters; letters &= (letters - 1))
+  {
+    int index = __builtin_ctz(letters);
+
+    node_t* child = *(children++);
+
+    node_t* merged_child = node_child_get(merged, index);
+
+    if(!merged_child)
+    {
+      merged_child = node_child_add(merged, index);
+
+      if(!merged_child) return -1;
+    }
+
+    int child_amount = node_merge(merged_child, child, tier);
+
+    if(child_amount == -1) return -1;
+
+    amount += child_amount;
+  }
+
+  merged->word_count += amount;
+
+  return amount;
+}
+
+/*
+ * Merge the words of trie into merged, tagged with tier
+ *
+ * Every word is tagged with the lowest tier that has it,
+ * so the tiers can be merged in any order
+ *
+ * EXPECTS:
+ * - merged is not minimized
+ *
+ * PARAMS
+ * - size_t* duplicate_count | Increased by the words merged already had, or NULL
+ *
+ * RETURN (int status)
+ * - 0 | Success
+ * - 1 | Bad input or failed to allocate
+ */
+int trie_tier_merge(trie_t* merged, trie_t* trie, int tier, size_t* duplicate_count)
+{
+  if(!merged || !trie) return 1;
+
+  int amount = node_merge((node_t*) merged, (node_t*) trie, tier);
+
+  if(amount == -1) return 1;
+
+  if(duplicate_count)
+  {
+    *duplicate_count += (trie_word_count(trie) - amount);
+  }
+
+  return 0;
+}
+
+/*
+ * Tag every word under node with tier
+ */
+static void node_tier_set(node_t* node, int tier)
+{
+  if(node->is_end_of_word) node->tier = tier;
+
+  int child_count = __builtin_popcount(node->letters);
+
+  for(int position = 0; position < child_count; position++)
+  {
+    node_tier_set(node->children[position], tier);
+  }
+}
+
+/*
+ * Tag every word of trie with tier
+ *
+ * EXPECTS:
+ * - trie is not minimized
+ */
+void trie_tier_set(trie_t* trie, int tier)
+{
+  if(!trie) return;
+
+  node_tier_set((node_t*) trie, tier);
+}
+
+/*
+ * Get the amount of words in trie
+ */
+size_t trie_word_count(trie_t* trie)
+{
+  return trie ? ((node_t*) trie)->word_count : 0;
 }
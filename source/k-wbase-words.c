@@ -5,19 +5,17 @@
 #include "k-wbase.h"
 #include "k-wbase-intern.h"
 
-#include "k-grid-intern.h"
-
 // __builtin_clzll counts the leading zeros, so the bit length is:
 #define CAPACITY(n) (1ULL << (64 - __builtin_clzll(n)))
 
 /*
- * Append word in word array
+ * Append a copy of word in word array
  *
  * RETURN (int status)
  * - 0 | Success
  * - 1 | Failed to allocate memory
  */
-static int word_append(char*** words, size_t* count, char* word)
+int words_append(char*** words, size_t* count, const char* word)
 {
   if(*count == 0 || ((*count) + 1) >= CAPACITY(*count))
   {
@@ -52,12 +50,15 @@ void words_free(char*** words, size_t count)
 
 /*
  * Shuffle word array
+ *
+ * PARAMS
+ * - unsigned int* seed | The seed of rand_r, which is advanced
  */
-void words_shuffle(char** words, size_t count)
+void words_shuffle(char** words, size_t count, unsigned int* seed)
 {
   for(size_t index = 0; index < count; index++)
   {
-    size_t rand_index = (rand() % count);
+    size_t rand_index = (rand_r(seed) % count);
 
     char* temp_word = words[index];
 
@@ -67,86 +68,6 @@ void words_shuffle(char** words, size_t count)
   }
 }
 
-/*
- * Get the words in grid
- *
- * The function allocates an array of words, which has to be freed
- *
- * RETURN (int status)
- * - 0 | Success
- * - 1 | Bad input
- */
-int grid_words_get(char*** words, size_t* count, grid_t* grid)
-{
-  if(!words || !count || !grid) return 1;
-
-  // Identify vertical words and remember them
-  for(int x = 3; x < (grid->width + 4); x++)
-  {
-    char word[grid->height + 1];
-    int  length = 0;
-
-    for(int y = 3; y < (grid->height + 4); y++)
-    {
-      square_t* square = xy_real_square_get(grid, x, y);
-
-      if(square->type == SQUARE_EMPTY)
-      {
-        length = 0;
-      }
-      else if(square->type == SQUARE_BLOCK || square->type == SQUARE_BORDER)
-      {
-        if(length > 1)
-        {
-          word[length++] = '\0';
-
-          word_append(words, count, word);
-        }
-
-        length = 0;
-      }
-      else if(square->type == SQUARE_LETTER)
-      {
-        word[length++] = square->letter;
-      }
-    }
-  }
-
-  // Identify horizontal words and remember them
-  for(int y = 2; y < (grid->height + 4); y++)
-  {
-    char word[grid->width + 1];
-    int  length = 0;
-
-    for(int x = 2; x < (grid->width + 4); x++)
-    {
-      square_t* square = xy_real_square_get(grid, x, y);
-
-      if(square->type == SQUARE_EMPTY)
-      {
-        length = 0;
-      }
-      else if(square->type == SQUARE_BLOCK || square->type == SQUARE_BORDER)
-      {
-        if(length > 1)
-        {
-          word[length++] = '\0';
-
-          word_append(words, count, word);
-        }
-
-        length = 0;
-      }
-      else if(square->type == SQUARE_LETTER)
-      {
-        word[length++] = square->letter;
-      }
-    }
-  }
-
-  return 0;
-}
-
 /*
  * Recursive word search function
  *
@@ -165,7 +86,7 @@ static void _words_search(char*** words, size_t* count, node_t* node, node_t* us
     if(node->is_end_of_word &&
        (!used_node || !used_node->is_end_of_word))
     {
-      word_append(words, count, word);
+      words_append(words, count, word);
     }
 
     return;
@@ -176,12 +97,12 @@ static void _words_search(char*** words, size_t* count, node_t* node, node_t* us
 
   if(letter_index != -1)
   {
-    node_t* child = node->children[letter_index];
+    node_t* child = node_child_get(node, letter_index);
 
     // If no words have the letter, abort
     if(!child) return;
 
-    node_t* used_child = used_node ? used_node->children[letter_index] : NULL;
+    node_t* used_child = used_node ? node_child_get(used_node, letter_index) : NULL;
 
     char new_word[index + 2];
 
@@ -193,14 +114,16 @@ static void _words_search(char*** words, size_t* count, node_t* node, node_t* us
   }
   else
   {
-    for(int child_index = 0; child_index < ALPHABET_SIZE; child_index++)
+    node_t** children = node->children;
+
+    // Only go through the allocated letters
+    for(uint32_t letters = node->letters; letters; letters &= (letters - 1))
     {
-      node_t* child = node->children[child_index];
+      int child_index = __builtin_ctz(letters);
 
-      // Only go through the allocated letters
-      if(!child) continue;
+      node_t* child = *(children++);
 
-      node_t* used_child = used_node ? used_node->children[child_index] : NULL;
+      node_t* used_child = used_node ? node_child_get(used_node, child_index) : NULL;
 
       char new_word[index + 2];
 
@@ -227,6 +150,530 @@ int words_search(char*** words, size_t* count, trie_t* trie, trie_t* used_trie,
   return 0;
 }
 
+/*
+ * Check if the first length chars of line are all letters,
+ * meaning that the words of that length are already determined
+ */
+static bool line_is_lettered(const char* line, int length)
+{
+  for(int index = 0; index < length; index++)
+  {
+    if(letter_index_get(line[index]) == -1) return false;
+  }
+
+  return true;
+}
+
+
+/*
+ * Recursive function for counting the used words for pattern,
+ * which are also words under node
+ *
+ * RETURN (int amount)
+ */
+static int _used_words_count(node_t* used_node, node_t* node, const char* pattern, size_t length, size_t index)
+{
+  // Base case - the end of the word
+  if(index >= length)
+  {
+    return (used_node->is_end_of_word && node->is_end_of_word);
+  }
+
+  int letter_index = letter_index_get(pattern[index]);
+
+  if(letter_index != -1)
+  {
+    node_t* used_child = node_child_get(used_node, letter_index);
+    node_t* child      = node_child_get(node, letter_index);
+
+    if(!used_child || !child) return 0;
+
+    return _used_words_count(used_child, child, pattern, length, index + 1);
+  }
+
+  int amount = 0;
+
+  // The used words are few, so only their letters are gone through
+  node_t** used_children = used_node->children;
+
+  for(uint32_t letters = used_node->letters; letters; letters &= (letters - 1))
+  {
+    int child_index = __builtin_ctz(letters);
+
+    node_t* used_child = *(used_children++);
+    node_t* child      = node_child_get(node, child_index);
+
+    if(!child) continue;
+
+    amount += _used_words_count(used_child, child, pattern, length, index + 1);
+  }
+
+  return amount;
+}
+
+/*
+ * Count the words of word base for the first length letters of pattern,
+ * by matching the packed words
+ *
+ * The used words are few, so they are counted in the used trie
+ * and subtracted from the matches
+ *
+ * EXPECTS:
+ * - word base has packed words
+ * - length is at most PACK_MAX_LENGTH
+ *
+ * RETURN (int amount)
+ * - min | 0
+ * - max | max_amount
+ */
+static int pack_wbase_words_count(wbase_t* wbase, trie_t* used_trie, const char* pattern, size_t length, int max_amount)
+{
+  if(max_amount <= 0) return 0;
+
+  int used_count = 0;
+
+  if(used_trie)
+  {
+    used_count = _used_words_count((node_t*) used_trie, (node_t*) wbase->trie, pattern, length, 0);
+  }
+
+  int amount = pack_words_count(wbase->pack, pattern, length, max_amount + used_count);
+
+  return MIN(amount - used_count, max_amount);
+}
+
+/*
+ * Count word if word base has it
+ *
+ * A used word is not counted
+ *
+ * EXPECTS:
+ * - word base has a word set
+ *
+ * RETURN (int amount)
+ */
+static int wbase_word_count(wbase_t* wbase, trie_t* used_trie, const char* word, size_t length)
+{
+  int amount = wset_word_exists(wbase->wset, word, length);
+
+  // The used words are few, so they are only checked on a hit
+  if(amount > 0 && used_trie)
+  {
+    char used_word[length + 1];
+
+    memcpy(used_word, word, sizeof(char) * length);
+
+    used_word[length] = '\0';
+
+    if(trie_word_exists(used_trie, used_word)) return 0;
+  }
+
+  return amount;
+}
+
+/*
+ * Check if word base has word
+ *
+ * EXPECTS:
+ * - word base has a word set
+ */
+static bool wbase_word_exists(wbase_t* wbase, const char* word, size_t length)
+{
+  return wset_word_exists(wbase->wset, word, length);
+}
+
+/*
+ * Recursive span search function
+ *
+ * Every word that ends at a stop length is appended
+ * to the word array of its tier and that length
+ *
+ * PARAMS
+ * - char* word | Buffer of the letters sience root
+ */
+static void _span_words_search(char*** words, size_t* counts, node_t* node, node_t* used_node, const char* line, const bool* is_stop, int stop_length, int index, char* word)
+{
+  if(is_stop[index] && node->is_end_of_word &&
+     (!used_node || !used_node->is_end_of_word))
+  {
+    word[index] = '\0';
+
+    size_t bucket = (node->tier * (stop_length + 1)) + index;
+
+    words_append(&words[bucket], &counts[bucket], word);
+  }
+
+  // Base case - the longest span is done
+  if(index >= stop_length) return;
+
+  // Search words with next letter
+  int letter_index = letter_index_get(line[index]);
+
+  if(letter_index != -1)
+  {
+    node_t* child = node_child_get(node, letter_index);
+
+    // If no words have the letter, abort
+    if(!child) return;
+
+    node_t* used_child = used_node ? node_child_get(used_node, letter_index) : NULL;
+
+    word[index] = line[index];
+
+    _span_words_search(words, counts, child, used_child, line, is_stop, stop_length, index + 1, word);
+  }
+  else
+  {
+    node_t** children = node->children;
+
+    // Only go through the allocated letters
+    for(uint32_t letters = node->letters; letters; letters &= (letters - 1))
+    {
+      int child_index = __builtin_ctz(letters);
+
+      node_t* child = *(children++);
+
+      node_t* used_child = used_node ? node_child_get(used_node, child_index) : NULL;
+
+      word[index] = index_letter_get(child_index);
+
+      _span_words_search(words, counts, child, used_child, line, is_stop, stop_length, index + 1, word);
+    }
+  }
+}
+
+/*
+ * Search words of every stop length that match the start of line
+ *
+ * This walks the trie once, instead of once for every stop,
+ * so the shared prefixes of the spans are only walked once
+ *
+ * The words of tier and length are appended to
+ * words[(tier * (stop_length + 1)) + length]
+ *
+ * EXPECTS:
+ * - words and counts have (stop_length + 1) items for every tier, which are empty
+ * - is_stop has stop_length + 1 items, where is_stop[length]
+ *   tells if words of that length should be searched
+ *
+ * PARAMS
+ * - const char* line | The pattern from the start of the spans
+ */
+int span_words_search(char*** words, size_t* counts, trie_t* trie, trie_t* used_trie, const char* line, const bool* is_stop, int stop_length)
+{
+  if(!words || !counts || !trie || !line || !is_stop) return 1;
+
+  char word[stop_length + 1];
+
+  _span_words_search(words, counts, (node_t*) trie, (node_t*) used_trie, line, is_stop, stop_length, 0, word);
+
+  return 0;
+}
+
+/*
+ * Recursive function for counting existing words of every stop length
+ *
+ * RETURN (int amount)
+ */
+static int _span_words_exist(node_t* node, node_t* used_node, const char* line, const bool* is_stop, int stop_length, int index, int max_amount)
+{
+  // This evaluates to 0 if false and 1 if true
+  // which represents that 'a' word exist
+  int amount = (is_stop[index] && node->is_end_of_word &&
+               (!used_node || !used_node->is_end_of_word));
+
+  // Base case - the longest span is done
+  if(index >= stop_length || amount >= max_amount)
+  {
+    return MIN(amount, max_amount);
+  }
+
+  // Search words with next letter
+  int letter_index = letter_index_get(line[index]);
+
+  if(letter_index != -1)
+  {
+    node_t* child = node_child_get(node, letter_index);
+
+    // If no words have the letter, no more words exist
+    if(!child) return amount;
+
+    node_t* used_child = used_node ? node_child_get(used_node, letter_index) : NULL;
+
+    amount += _span_words_exist(child, used_child, line, is_stop, stop_length, index + 1, max_amount - amount);
+  }
+  else
+  {
+    node_t** children = node->children;
+
+    // Only go through the allocated letters
+    for(uint32_t letters = node->letters; letters; letters &= (letters - 1))
+    {
+      int child_index = __builtin_ctz(letters);
+
+      node_t* child = *(children++);
+
+      node_t* used_child = used_node ? node_child_get(used_node, child_index) : NULL;
+
+      // max_amount - amount means that the next node
+      // only get to search the REST of max_amount
+      amount += _span_words_exist(child, used_child, line, is_stop, stop_length, index + 1, max_amount - amount);
+
+      // This is opimization only for performance
+      if(amount >= max_amount) break;
+    }
+  }
+
+  return MIN(amount, max_amount);
+}
+
+/*
+ * Count how many words in word base exist for the spans of line
+ *
+ * RETURN (int amount)
+ * - min | 0
+ * - max | max_amount
+ */
+static int span_words_exist(wbase_t* wbase, trie_t* used_trie, const char* line, const bool* is_stop, int stop_length, int max_amount)
+{
+  int amount = 0;
+
+  // Without a first letter the trie can't skip any words,
+  // so short spans are matched in bulk instead
+  if(wbase->pack && stop_length <= PACK_MAX_LENGTH &&
+     letter_index_get(line[0]) == -1)
+  {
+    for(int length = 1; length <= stop_length; length++)
+    {
+      if(!is_stop[length]) continue;
+
+      amount += pack_wbase_words_count(wbase, used_trie, line, length, max_amount - amount);
+
+      if(amount >= max_amount) return max_amount;
+    }
+
+    return amount;
+  }
+
+  // Every span is already lettered, so each is only one word
+  if(wbase->wset && line_is_lettered(line, stop_length))
+  {
+    for(int length = 1; length <= stop_length; length++)
+    {
+      if(!is_stop[length]) continue;
+
+      amount += wbase_word_count(wbase, used_trie, line, length);
+
+      if(amount >= max_amount) return max_amount;
+    }
+
+    return amount;
+  }
+
+  if(wbase->darray)
+  {
+    return darray_span_words_exist(wbase->darray, used_trie, line, is_stop, stop_length, max_amount);
+  }
+
+  return _span_words_exist((node_t*) wbase->trie, (node_t*) used_trie, line, is_stop, stop_length, 0, max_amount);
+}
+
+/*
+ * Recursive function for checking if a word of any stop length exists
+ *
+ * RETURN (bool does_exist)
+ */
+static bool _span_word_exists(node_t* node, const char* line, const bool* is_stop, int stop_length, int index)
+{
+  if(is_stop[index] && node->is_end_of_word) return true;
+
+  // Base case - the longest span is done
+  if(index >= stop_length) return false;
+
+  // Search words with next letter
+  int letter_index = letter_index_get(line[index]);
+
+  if(letter_index != -1)
+  {
+    node_t* child = node_child_get(node, letter_index);
+
+    // If no words have the letter, no word exists
+    if(!child) return false;
+
+    return _span_word_exists(child, line, is_stop, stop_length, index + 1);
+  }
+
+  node_t** children = node->children;
+
+  // Only go through the allocated letters
+  for(uint32_t letters = node->letters; letters; letters &= (letters - 1))
+  {
+    node_t* child = *(children++);
+
+    if(_span_word_exists(child, line, is_stop, stop_length, index + 1))
+    {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+/*
+ * Check if a word in trie exists for the spans of line
+ *
+ * PARAMS
+ * - darray_t* darray | The trie as a double array, or NULL
+ *
+ * RETURN (bool does_exist)
+ */
+static bool trie_span_word_exists(trie_t* trie, darray_t* darray, const char* line, const bool* is_stop, int stop_length)
+{
+  if(darray) return darray_span_word_exists(darray, line, is_stop, stop_length);
+
+  if(!trie) return false;
+
+  return _span_word_exists((node_t*) trie, line, is_stop, stop_length, 0);
+}
+
+/*
+ * Check if a word in word base exists for the spans of line
+ *
+ * RETURN (bool does_exist)
+ */
+static bool span_word_exists(wbase_t* wbase, const char* line, const bool* is_stop, int stop_length)
+{
+  // Every span is already lettered, so each is only one word
+  if(wbase->wset && line_is_lettered(line, stop_length))
+  {
+    for(int length = 1; length <= stop_length; length++)
+    {
+      if(is_stop[length] && wbase_word_exists(wbase, line, length)) return true;
+    }
+
+    return false;
+  }
+
+  return trie_span_word_exists(wbase->trie, wbase->darray, line, is_stop, stop_length);
+}
+
+/*
+ * Check if a word in word base exists for the spans of a reversed line
+ *
+ * RETURN (bool does_exist)
+ */
+static bool rev_span_word_exists(wbase_t* wbase, const char* rev_line, const bool* is_start, int start_length)
+{
+  // Every span is already lettered, so each is only one word
+  if(wbase->wset && line_is_lettered(rev_line, start_length))
+  {
+    // The word sets have the words forwards
+    char line[start_length];
+
+    for(int index = 0; index < start_length; index++)
+    {
+      line[index] = rev_line[start_length - 1 - index];
+    }
+
+    for(int length = 1; length <= start_length; length++)
+    {
+      if(!is_start[length]) continue;
+
+      if(wbase_word_exists(wbase, line + (start_length - length), length)) return true;
+    }
+
+    return false;
+  }
+
+  return trie_span_word_exists(wbase->rev_trie, wbase->rev_darray, rev_line, is_start, start_length);
+}
+
+/*
+ * Count how many words in word base exist for the spans of line
+ *
+ * The amount is remembered for the used words, see k-wbase-cache.c
+ *
+ * EXPECTS:
+ * - is_stop has stop_length + 1 items, see span_words_search
+ *
+ * PARAMS
+ * - uint64_t used_hash | Hash of the used words in used_trie
+ *
+ * RETURN (int amount)
+ * - min | 0
+ * - max | max_amount
+ */
+int wbase_span_words_exist(wbase_t* wbase, trie_t* used_trie, uint64_t used_hash, const char* line, const bool* is_stop, int stop_length, int max_amount)
+{
+  int amount = 0;
+
+  if(query_cache_get(&amount, wbase, used_hash, QUERY_SPAN_COUNT, line, is_stop, stop_length, max_amount))
+  {
+    return amount;
+  }
+
+  amount = span_words_exist(wbase, used_trie, line, is_stop, stop_length, max_amount);
+
+  query_cache_set(wbase, used_hash, QUERY_SPAN_COUNT, line, is_stop, stop_length, amount, max_amount);
+
+  return amount;
+}
+
+/*
+ * Check if a word in word base exists for the spans of line
+ *
+ * Like wbase_word_exists_for_pattern, used words also count
+ *
+ * EXPECTS:
+ * - is_stop has stop_length + 1 items, see span_words_search
+ *
+ * RETURN (bool does_exist)
+ */
+bool wbase_span_word_exists(wbase_t* wbase, const char* line, const bool* is_stop, int stop_length)
+{
+  int amount = 0;
+
+  if(query_cache_get(&amount, wbase, 0, QUERY_SPAN_EXISTS, line, is_stop, stop_length, 1))
+  {
+    return (amount > 0);
+  }
+
+  bool does_exist = span_word_exists(wbase, line, is_stop, stop_length);
+
+  query_cache_set(wbase, 0, QUERY_SPAN_EXISTS, line, is_stop, stop_length, does_exist, 1);
+
+  return does_exist;
+}
+
+/*
+ * Check if a word in word base exists for the spans of a reversed line,
+ * meaning the words stop at the first letter of rev_line
+ *
+ * EXPECTS:
+ * - is_start has start_length + 1 items, where is_start[length]
+ *   tells if words of that length should be searched
+ *
+ * PARAMS
+ * - const char* rev_line | The pattern from the stop, backwards
+ *
+ * RETURN (bool does_exist)
+ */
+bool wbase_rev_span_word_exists(wbase_t* wbase, const char* rev_line, const bool* is_start, int start_length)
+{
+  int amount = 0;
+
+  if(query_cache_get(&amount, wbase, 0, QUERY_REV_SPAN_EXISTS, rev_line, is_start, start_length, 1))
+  {
+    return (amount > 0);
+  }
+
+  bool does_exist = rev_span_word_exists(wbase, rev_line, is_start, start_length);
+
+  query_cache_set(wbase, 0, QUERY_REV_SPAN_EXISTS, rev_line, is_start, start_length, does_exist, 1);
+
+  return does_exist;
+}
+
 /*
  * Recursive function for counting existing words
  *
@@ -250,12 +697,12 @@ static int _words_exist_for_pattern(node_t* node, node_t* used_node, const char*
 
   if(letter_index != -1)
   {
-    node_t* child = node->children[letter_index];
+    node_t* child = node_child_get(node, letter_index);
 
     // If no words have the letter, amount 0 is returned
     if(!child) return 0;
 
-    node_t* used_child = used_node ? used_node->children[letter_index] : NULL;
+    node_t* used_child = used_node ? node_child_get(used_node, letter_index) : NULL;
 
     char new_word[index + 2];
 
@@ -267,14 +714,16 @@ static int _words_exist_for_pattern(node_t* node, node_t* used_node, const char*
   }
   else
   {
-    for(int child_index = 0; child_index < ALPHABET_SIZE; child_index++)
+    node_t** children = node->children;
+
+    // Only go through the allocated letters
+    for(uint32_t letters = node->letters; letters; letters &= (letters - 1))
     {
-      node_t* child = node->children[child_index];
+      int child_index = __builtin_ctz(letters);
 
-      // Only go through the allocated letters
-      if(!child) continue;
+      node_t* child = *(children++);
 
-      node_t* used_child = used_node ? used_node->children[child_index] : NULL;
+      node_t* used_child = used_node ? node_child_get(used_node, child_index) : NULL;
 
       char new_word[index + 2];
 
@@ -317,16 +766,21 @@ static int words_exist_for_pattern(trie_t* trie, trie_t* used_trie, const char*
  */
 int wbase_words_exist_for_pattern(wbase_t* wbase, trie_t* used_trie, const char* pattern, int max_amount)
 {
-  int amount = 0;
+  size_t length = strlen(pattern);
 
-  for(size_t index = 0; index < wbase->count; index++)
+  // A lettered pattern is only one word
+  if(wbase->wset && line_is_lettered(pattern, length))
   {
-    amount += words_exist_for_pattern(wbase->tries[index], used_trie, pattern, max_amount - amount);
+    return MIN(wbase_word_count(wbase, used_trie, pattern, length), max_amount);
+  }
 
-    if(amount >= max_amount) return max_amount;
+  // Short words are matched in bulk
+  if(wbase->pack && length <= PACK_MAX_LENGTH)
+  {
+    return pack_wbase_words_count(wbase, used_trie, pattern, length, max_amount);
   }
 
-  return amount;
+  return words_exist_for_pattern(wbase->trie, used_trie, pattern, max_amount);
 }
 
 /*
@@ -348,12 +802,12 @@ static bool _word_exists_for_pattern(node_t* node, node_t* used_node, const char
 
   if(letter_index != -1)
   {
-    node_t* child = node->children[letter_index];
+    node_t* child = node_child_get(node, letter_index);
 
     // If no words have the letter, amount 0 is returned
     if(!child) return false;
 
-    node_t* used_child = used_node ? used_node->children[letter_index] : NULL;
+    node_t* used_child = used_node ? node_child_get(used_node, letter_index) : NULL;
 
     char new_word[index + 2];
 
@@ -365,14 +819,16 @@ static bool _word_exists_for_pattern(node_t* node, node_t* used_node, const char
   }
   else
   {
-    for(int child_index = 0; child_index < ALPHABET_SIZE; child_index++)
+    node_t** children = node->children;
+
+    // Only go through the allocated letters
+    for(uint32_t letters = node->letters; letters; letters &= (letters - 1))
     {
-      node_t* child = node->children[child_index];
+      int child_index = __builtin_ctz(letters);
 
-      // Only go through the allocated letters
-      if(!child) continue;
+      node_t* child = *(children++);
 
-      node_t* used_child = used_node ? used_node->children[child_index] : NULL;
+      node_t* used_child = used_node ? node_child_get(used_node, child_index) : NULL;
 
       char new_word[index + 2];
 
@@ -409,13 +865,19 @@ static bool word_exists_for_pattern(trie_t* trie, trie_t* used_trie, const char*
  */
 bool wbase_word_exists_for_pattern(wbase_t* wbase, trie_t* used_trie, const char* pattern)
 {
-  for(size_t index = 0; index < wbase->count; index++)
+  size_t length = strlen(pattern);
+
+  // A lettered pattern is only one word
+  if(wbase->wset && line_is_lettered(pattern, length))
   {
-    if(word_exists_for_pattern(wbase->tries[index], used_trie, pattern))
-    {
-      return true;
-    }
+    return wbase_word_exists(wbase, pattern, length);
   }
 
-  return false;
+  // Short words are matched in bulk
+  if(wbase->pack && length <= PACK_MAX_LENGTH)
+  {
+    return (pack_words_count(wbase->pack, pattern, length, 1) > 0);
+  }
+
+  return word_exists_for_pattern(wbase->trie, used_trie, pattern);
 }
@@ -5,6 +5,17 @@
 #include "k-wbase.h"
 #include "k-wbase-intern.h"
 
+/*
+ * Minimize the tries of the word files into word graphs,
+ * which share the common endings of words
+ */
+bool MINIMIZE_TRIES = false;
+
+/*
+ * Search the tries of the word files as double arrays
+ */
+bool DOUBLE_ARRAY_TRIES = false;
+
 /*
  * RETURN (char letter)
  * - '_' | Index out of range
@@ -37,44 +48,215 @@ int letter_index_get(char letter)
 }
 
 /*
- * Create word base structure wbase
+ * Create word base of the merged words in trie, and the same words reversed
+ *
+ * The word base takes both tries, which are freed with the word base
  *
  * PARAMS
- * - char** wfiles  | Word files
- * - size_t count   | Number of word files
+ * - trie_t* trie     | Every word, tagged with its tier
+ * - trie_t* rev_trie | Every word reversed, tagged with its tier
+ * - size_t  count    | Number of tiers
  *
  * RETURN (wbase_t* wbase)
  * - NULL | Failed to create wbase
  */
-wbase_t* wbase_create(char** wfiles, size_t count)
+wbase_t* wbase_tries_build(trie_t* trie, trie_t* rev_trie, size_t count)
 {
-  if (!wfiles || count == 0) return NULL;
+  wbase_t* wbase = trie ? calloc(1, sizeof(wbase_t)) : NULL;
 
-  // 1. Allocate memory for wbase
-  wbase_t* wbase = malloc(sizeof(wbase_t));
+  if(!wbase)
+  {
+    trie_free(&trie);
 
-  if(!wbase) return NULL;
+    trie_free(&rev_trie);
 
-  trie_t** tries = malloc(sizeof(trie_t*) * count);
+    return NULL;
+  }
 
-  if(!tries)
+  wbase->trie  = trie;
+  wbase->count = count;
+
+  wbase->rev_trie = rev_trie;
+
+  wbase->wset = wset_create(trie);
+
+  wbase->pack = pack_create(trie);
+
+  if(!wbase->rev_trie || !wbase->wset || !wbase->pack)
   {
-    free(wbase);
+    wbase_free(&wbase);
 
     return NULL;
   }
 
-  wbase->tries = tries;
-  wbase->count = count;
+  if(DOUBLE_ARRAY_TRIES)
+  {
+    wbase->darray = darray_create(wbase->trie);
 
-  for(size_t index = 0; index < count; index++)
+    wbase->rev_darray = darray_create(wbase->rev_trie);
+
+    if(!wbase->darray || !wbase->rev_darray)
+    {
+      wbase_free(&wbase);
+
+      return NULL;
+    }
+  }
+
+  if(MINIMIZE_TRIES)
   {
-    wbase->tries[index] = trie_load(wfiles[index]);
+    if(trie_minimize(wbase->trie) != 0 || trie_minimize(wbase->rev_trie) != 0)
+    {
+      wbase_free(&wbase);
+
+      return NULL;
+    }
   }
 
   return wbase;
 }
 
+/*
+ * Create word base of the merged words in trie
+ *
+ * The word base takes trie, which is freed with the word base
+ *
+ * PARAMS
+ * - trie_t* trie | Every word, tagged with its tier
+ * - size_t count | Number of tiers
+ *
+ * RETURN (wbase_t* wbase)
+ * - NULL | Failed to create wbase
+ */
+wbase_t* wbase_build(trie_t* trie, size_t count)
+{
+  if(!trie) return NULL;
+
+  return wbase_tries_build(trie, trie_reverse(trie), count);
+}
+
+/*
+ * Merge tries into the largest of them
+ *
+ * The other tries are freed, and every word is tagged
+ * with the index of the first trie that has it.
+ * The words in more than one trie are only kept once
+ *
+ * RETURN (trie_t* trie)
+ * - NULL | No tries or failed to allocate
+ */
+static trie_t* tries_merge(trie_t** tries, size_t count)
+{
+  // 1. The other tries are merged into the largest trie
+  size_t base = 0;
+
+  for(size_t index = 1; index < count; index++)
+  {
+    if(trie_word_count(tries[index]) > trie_word_count(tries[base])) base = index;
+  }
+
+  trie_t* trie = tries[base];
+
+  tries[base] = NULL;
+
+  if(!trie) return NULL;
+
+  trie_tier_set(trie, base);
+
+  // 2. Merge the words of the other tries
+  int status = 0;
+
+  size_t duplicate_count = 0;
+
+  for(size_t index = 0; index < count; index++)
+  {
+    if(status == 0 && tries[index])
+    {
+      status = trie_tier_merge(trie, tries[index], index, &duplicate_count);
+    }
+
+    trie_free(&tries[index]);
+  }
+
+  if(status != 0)
+  {
+    trie_free(&trie);
+
+    return NULL;
+  }
+
+  info_print("Dropped %zu duplicate words", duplicate_count);
+
+  return trie;
+}
+
+/*
+ * Create word base structure wbase
+ *
+ * The word files are loaded at the same time, and their words
+ * are merged into one trie, where every word is tagged
+ * with the first word file that has it
+ *
+ * PARAMS
+ * - char** wfiles  | Word files
+ * - size_t count   | Number of word files
+ * - int max_length | Longer words are not loaded
+ *
+ * RETURN (wbase_t* wbase)
+ * - NULL | Failed to create wbase
+ */
+wbase_t* wbase_create(char** wfiles, size_t count, int max_length)
+{
+  if (!wfiles || count == 0) return NULL;
+
+  trie_t* tries[count];
+
+  int max_lengths[count];
+
+  for(size_t index = 0; index < count; index++)
+  {
+    max_lengths[index] = max_length;
+  }
+
+  tries_load(tries, wfiles, max_lengths, count);
+
+  return wbase_build(tries_merge(tries, count), count);
+}
+
+/*
+ * Get the tier of word, which is the index of the first word file
+ * containing the word. Lower tiers are prioritized
+ *
+ * RETURN (int tier)
+ * - -1 | The word is not in word base
+ */
+int wbase_word_tier_get(wbase_t* wbase, const char* word)
+{
+  if(wbase->wset)
+  {
+    return wset_word_tier_get(wbase->wset, word, strlen(word));
+  }
+
+  return trie_word_tier_get(wbase->trie, word);
+}
+
+/*
+ * Get the theme score of word
+ *
+ * Words in the last word file (the backup) give no score,
+ * and every tier above it gives one more
+ *
+ * RETURN (int score)
+ */
+int wbase_word_score_get(wbase_t* wbase, const char* word)
+{
+  int tier = wbase_word_tier_get(wbase, word);
+
+  if(tier == -1) return 0;
+
+  return (wbase->count - 1) - tier;
+}
+
 /*
  * Free word base struct
  */
@@ -82,12 +264,17 @@ void wbase_free(wbase_t** wbase)
 {
   if(!wbase || !(*wbase)) return;
 
-  for(size_t index = 0; index < (*wbase)->count; index++)
-  {
-    trie_free(&(*wbase)->tries[index]);
-  }
+  trie_free(&(*wbase)->trie);
+
+  trie_free(&(*wbase)->rev_trie);
+
+  wset_free(&(*wbase)->wset);
+
+  pack_free(&(*wbase)->pack);
+
+  darray_free(&(*wbase)->darray);
 
-  free((*wbase)->tries);
+  darray_free(&(*wbase)->rev_darray);
 
   free(*wbase);
 
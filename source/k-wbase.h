@@ -7,13 +7,36 @@
 
 #include <stddef.h>
 #include <stdbool.h>
+#include <stdint.h>
 
 typedef struct node_t trie_t;
 
+typedef struct wset_t wset_t;
+
+typedef struct pack_t pack_t;
+
+typedef struct darray_t darray_t;
+
+typedef struct live_t live_t;
+
+/*
+ * The words of every tier are merged into one trie, where every word
+ * is tagged with its tier, and a trie of the words reversed,
+ * which is used to search words that stop at a given letter.
+ * The words are also in a set, to look up whole words,
+ * and the short words are packed, to match them in bulk
+ *
+ * With double arrays, the tries are also searched as double arrays
+ */
 typedef struct wbase_t
 {
-  trie_t** tries;
-  size_t   count;
+  trie_t*   trie;
+  trie_t*   rev_trie;
+  wset_t*   wset;
+  pack_t*   pack;
+  darray_t* darray;
+  darray_t* rev_darray;
+  size_t    count;      // The number of tiers
 } wbase_t;
 
 
@@ -24,7 +47,11 @@ extern char index_letter_get(int index);
 
 extern trie_t* trie_create(void);
 
-extern trie_t* trie_load(char* wfile);
+extern trie_t* trie_load(char* wfile, int max_length);
+
+extern void    tries_load(trie_t** tries, char** wfiles, const int* max_lengths, size_t count);
+
+extern void    trie_prune(trie_t* trie, int max_length);
 
 extern void    trie_free(trie_t** trie);
 
@@ -32,20 +59,73 @@ extern trie_t* trie_dup(trie_t* trie);
 
 extern void    trie_copy(trie_t** copy, trie_t* trie);
 
+extern trie_t* trie_reverse(trie_t* trie);
+
+extern int     trie_minimize(trie_t* trie);
+
+extern int     trie_word_id_get(trie_t* trie, const char* word);
+
+extern int     trie_word_tier_get(trie_t* trie, const char* word);
+
+extern int     trie_tier_merge(trie_t* merged, trie_t* trie, int tier, size_t* duplicate_count);
+
+extern void    trie_tier_set(trie_t* trie, int tier);
+
+extern size_t  trie_word_count(trie_t* trie);
+
+
+extern wset_t* wset_create(trie_t* trie);
+
+extern void    wset_free(wset_t** wset);
+
+extern int     wset_word_id_get(wset_t* wset, const char* word, size_t length);
+
+extern int     wset_word_tier_get(wset_t* wset, const char* word, size_t length);
+
+extern bool    wset_word_exists(wset_t* wset, const char* word, size_t length);
+
+
+extern pack_t* pack_create(trie_t* trie);
+
+extern void    pack_free(pack_t** pack);
+
+
+extern darray_t* darray_create(trie_t* trie);
+
+extern void      darray_free(darray_t** darray);
+
+extern int       darray_span_words_search(char*** words, size_t* counts, darray_t* darray, trie_t* used_trie, const char* line, const bool* is_stop, int stop_length);
+
 
 extern void trie_word_insert(trie_t* trie, const char* word);
 
+extern int  trie_word_tier_insert(trie_t* trie, const char* word, int tier);
+
 extern void trie_word_remove(trie_t* trie, const char* word);
 
+extern bool trie_word_exists(trie_t* trie, const char* word);
 
-extern wbase_t* wbase_create(char** wfiles, size_t count);
+
+extern wbase_t* wbase_build(trie_t* trie, size_t count);
+
+extern wbase_t* wbase_tries_build(trie_t* trie, trie_t* rev_trie, size_t count);
+
+extern wbase_t* wbase_create(char** wfiles, size_t count, int max_length);
 
 extern void     wbase_free(wbase_t** wbase);
 
+extern int      wbase_word_tier_get(wbase_t* wbase, const char* word);
+
+extern int      wbase_word_score_get(wbase_t* wbase, const char* word);
+
 
 extern int  words_search(char*** words, size_t* count, trie_t* trie, trie_t* used_trie, const char* pattern);
 
-extern void words_shuffle(char** words, size_t count);
+extern int  span_words_search(char*** words, size_t* counts, trie_t* trie, trie_t* used_trie, const char* line, const bool* is_stop, int stop_length);
+
+extern int  words_append(char*** words, size_t* count, const char* word);
+
+extern void words_shuffle(char** words, size_t count, unsigned int* seed);
 
 extern void words_free(char*** words, size_t count);
 
@@ -54,9 +134,27 @@ extern int  wbase_words_exist_for_pattern(wbase_t* wbase, trie_t* used_trie, con
 
 extern bool wbase_word_exists_for_pattern(wbase_t* wbase, trie_t* used_trie, const char* pattern);
 
+extern int  wbase_span_words_exist(wbase_t* wbase, trie_t* used_trie, uint64_t used_hash, const char* line, const bool* is_stop, int stop_length, int max_amount);
+
+extern bool wbase_span_word_exists(wbase_t* wbase, const char* line, const bool* is_stop, int stop_length);
+
+extern bool wbase_rev_span_word_exists(wbase_t* wbase, const char* rev_line, const bool* is_start, int start_length);
+
+extern void wbase_cache_clear(void);
+
+
+extern live_t*  live_create(wbase_t* wbase, trie_t* trie, int max_length);
+
+extern void     live_free(live_t** live);
+
+extern wbase_t* live_wbase_hold(live_t* live);
+
+extern void     live_wbase_release(void);
+
+extern int      live_word_add(live_t* live, const char* word, int tier);
 
-typedef struct grid_t grid_t;
+extern int      live_word_remove(live_t* live, const char* word);
 
-extern int grid_words_get(char*** words, size_t* count, grid_t* grid);
+extern int      live_publish(live_t* live);
 
 #endif // K_WBASE_H
@@ -33,6 +33,11 @@ bool is_running = false;
 extern int MAX_CROWD_AMOUNT;
 extern int MAX_WORD_LENGTH;
 extern int MAX_EXIST_AMOUNT;
+extern int MAX_GEN_TIME;
+extern int MAX_BATCH_WORKERS;
+extern bool MINIMIZE_TRIES;
+extern bool DOUBLE_ARRAY_TRIES;
+extern char* LIVE_WORDS_FIFO;
 
 static char doc[] = "korsord - swedish crossword generator";
 
@@ -45,6 +50,17 @@ static struct argp_option options[] =
   { "crowd",    'c', "AMOUNT", 0, "Max amount of nerby blocks" },
   { "exist",    'e', "AMOUNT", 0, "Amount of precission" },
   { "name",     'n', "NAME",   0, "Name of grid and clues" },
+  { "repair",   'r', 0,        0, "Repair partial grid of NAME" },
+  { "refill",   'f', "WORD",   0, "Replace word in grid of NAME" },
+  { "lock",     'k', "WORD",   0, "Keep word when repairing" },
+  { "amount",   'a', "AMOUNT", 0, "Generations to maximize theme words, in at most 60 seconds without --time" },
+  { "time",     't', "TIME",   0, "Max seconds of generating a grid" },
+  { "stream",   's', "FILE",   OPTION_ARG_OPTIONAL, "Stream improving grids to FILE or stdout, only FILE with --interact" },
+  { "batch",    'b', "FILE",   0, "Generate the grids of manifest FILE" },
+  { "workers",  'w', "AMOUNT", 0, "Max amount of batch workers" },
+  { "dawg",     'd', 0,        0, "Minimize the word tries into word graphs" },
+  { "darray",   'y', 0,        0, "Search the word tries as double arrays" },
+  { "live",     'v', "FIFO",   0, "Add and remove batch words through FIFO, only with --batch" },
   { 0 }
 };
 
@@ -55,36 +71,54 @@ struct args
   size_t wfile_count;
   bool   interact;
   char*  name;
+  bool   repair;
+  char** refills;
+  size_t refill_count;
+  char** locks;
+  size_t lock_count;
+  int    amount;
+  bool   stream;
+  char*  stream_file;
+  char*  batch;
 };
 
 // Default values of korsord arguments
 struct args args =
 {
-  .model       = NULL,
-  .wfiles      = NULL,
-  .wfile_count = 0,
-  .interact    = false,
-  .name        = "temp",
+  .model        = NULL,
+  .wfiles       = NULL,
+  .wfile_count  = 0,
+  .interact     = false,
+  .name         = "temp",
+  .repair       = false,
+  .refills      = NULL,
+  .refill_count = 0,
+  .locks        = NULL,
+  .lock_count   = 0,
+  .amount       = 1,
+  .stream       = false,
+  .stream_file  = NULL,
+  .batch        = NULL,
 };
 
 // __builtin_clzll counts the leading zeros, so the bit length is:
 #define CAPACITY(n) (1ULL << (64 - __builtin_clzll(n)))
 
 /*
- * Append word file to array of word files
+ * Append argument to array of arguments
  */
-static int wfile_append(char*** wfiles, size_t* count, char* wfile)
+static int arg_append(char*** args, size_t* count, char* arg)
 {
   if(*count == 0 || ((*count) + 1) >= CAPACITY(*count))
   {
-    char** new_wfiles = realloc(*wfiles, sizeof(char*) * CAPACITY((*count) + 1));
+    char** new_args = realloc(*args, sizeof(char*) * CAPACITY((*count) + 1));
 
-    if(!new_wfiles) return 1;
+    if(!new_args) return 1;
 
-    *wfiles = new_wfiles;
+    *args = new_args;
   }
 
-  (*wfiles)[(*count)++] = wfile;
+  (*args)[(*count)++] = arg;
 
   return 0;
 }
@@ -139,6 +173,66 @@ static error_t opt_parse(int key, char* arg, struct argp_state* state)
 
       break;
 
+    case 'a':
+      if(!arg || *arg == '-') argp_usage(state);
+
+      number = atoi(arg);
+
+      if(number >= 1)
+      {
+        args->amount = number;
+      }
+      else argp_usage(state);
+
+      break;
+
+    case 't':
+      if(!arg || *arg == '-') argp_usage(state);
+
+      number = atoi(arg);
+
+      if(number >= 1)
+      {
+        MAX_GEN_TIME = number;
+      }
+      else argp_usage(state);
+
+      break;
+
+    case 'w':
+      if(!arg || *arg == '-') argp_usage(state);
+
+      number = atoi(arg);
+
+      if(number >= 1)
+      {
+        MAX_BATCH_WORKERS = number;
+      }
+      else argp_usage(state);
+
+      break;
+
+    case 'b':
+      args->batch = arg;
+      break;
+
+    case 'd':
+      MINIMIZE_TRIES = true;
+      break;
+
+    case 'y':
+      DOUBLE_ARRAY_TRIES = true;
+      break;
+
+    case 'v':
+      LIVE_WORDS_FIFO = arg;
+      break;
+
+    case 's':
+      args->stream = true;
+      args->stream_file = arg;
+      break;
+
     case 'i':
       args->interact = true;
       break;
@@ -147,10 +241,22 @@ static error_t opt_parse(int key, char* arg, struct argp_state* state)
       args->name = arg;
       break;
 
+    case 'r':
+      args->repair = true;
+      break;
+
+    case 'f':
+      arg_append(&args->refills, &args->refill_count, arg);
+      break;
+
+    case 'k':
+      arg_append(&args->locks, &args->lock_count, arg);
+      break;
+
     case ARGP_KEY_ARG:
       if(state->arg_num > 0)
       {
-        wfile_append(&args->wfiles, &args->wfile_count, arg);
+        arg_append(&args->wfiles, &args->wfile_count, arg);
       }
       else
       {
@@ -159,7 +265,14 @@ static error_t opt_parse(int key, char* arg, struct argp_state* state)
       break;
 
     case ARGP_KEY_END:
-      if(state->arg_num < 2) argp_usage(state);
+      // A batch manifest has its own models and words
+      if(state->arg_num < 2 && !args->batch) argp_usage(state);
+
+      // Only the batch workers read live words
+      if(LIVE_WORDS_FIFO && !args->batch) argp_usage(state);
+
+      // Streamed grids on stdout would be drawn over by ncurses
+      if(args->stream && !args->stream_file && args->interact) argp_usage(state);
       break;
 
     default:
@@ -270,7 +383,16 @@ static void* gen_routine(void* wbase)
 
   grid_t* model = model_load(args.model);
 
-  grid_t* grid = grid_gen(wbase, model);
+  grid_t* grid;
+
+  if(args.amount > 1)
+  {
+    grid = grid_theme_gen(wbase, model, args.amount);
+  }
+  else
+  {
+    grid = grid_gen(wbase, model);
+  }
 
   if(grid)
   {
@@ -295,6 +417,88 @@ static void* gen_routine(void* wbase)
     error_print("Generation failed");
   }
 
+  is_generating = false;
+
+  best_grid_stream_flush();
+
+  grid_free(&model);
+
+  return NULL;
+}
+
+/*
+ * This routine repairs a partially generated grid
+ *
+ * The best grid is repaired if there is one,
+ * otherwise the grid of NAME is loaded and repaired
+ *
+ * If words are to be refilled, they are replaced
+ * and only the words crossing them are regenerated
+ *
+ * PARAMS:
+ * - void* wbase | Thread complient pointer to wbase
+ */
+static void* repair_routine(void* wbase)
+{
+  grid_t* partial = best_grid_dup();
+
+  if(!partial)
+  {
+    partial = grid_load(args.name);
+  }
+
+  if(!partial)
+  {
+    error_print("Failed to load grid: %s", args.name);
+
+    return NULL;
+  }
+
+  curr_grid_set(NULL);
+
+
+  // 2. Repair grid
+  info_print("Repairing grid");
+
+  grid_t* model = model_load(args.model);
+
+  grid_t* grid;
+
+  if(args.refill_count > 0)
+  {
+    grid = grid_refill(wbase, model, partial, args.refills, args.refill_count, args.locks, args.lock_count);
+  }
+  else
+  {
+    grid = grid_repair(wbase, model, partial, args.locks, args.lock_count);
+  }
+
+  if(grid)
+  {
+    curr_grid_set(grid);
+    best_grid_set(grid);
+
+    info_print("Repaired grid");
+
+
+    // 3. Export result to file
+    info_print("Exporting results");
+
+    grid_export(grid, args.name);
+
+    info_print("Exported results");
+
+
+    grid_free(&grid);
+  }
+  else
+  {
+    error_print("Repair failed");
+  }
+
+  best_grid_stream_flush();
+
+  grid_free(&partial);
   grid_free(&model);
 
   return NULL;
@@ -352,6 +556,19 @@ static int interact_routine(wbase_t* wbase)
         }
         break;
 
+      case 'f':
+        // This will stop the gen routine and repair the best grid
+        is_generating = false;
+
+        pthread_join(gen_thread, NULL);
+        gen_thread = 0;
+
+        if(pthread_create(&gen_thread, NULL, repair_routine, wbase) != 0)
+        {
+          error_print("Failed to create repair thread");
+        }
+        break;
+
       case 's':
         // Break the switch statement
         if(!is_generating) break;
@@ -402,6 +619,9 @@ static struct argp argp = { options, opt_parse, args_doc, doc };
  * RETURN (int status)
  * - 0 | Success
  *
+ * With a batch manifest, the status of grid_batch_gen is returned,
+ * which is not 0 if any grid failed
+ *
  * Note: Refactor this into step functions
  * (now the freeing at error is crazy)
  */
@@ -429,9 +649,36 @@ int main(int argc, char* argv[])
 
   info_print("Start main");
 
-  info_print("Creating word base");
+  if(args.batch)
+  {
+    int status = grid_batch_gen(args.batch, args.amount);
+
+    info_print("Stop main");
 
-  wbase_t* wbase = wbase_create(args.wfiles, args.wfile_count);
+    debug_file_close();
+
+    free(args.wfiles);
+    free(args.refills);
+    free(args.locks);
+
+    return status;
+  }
+
+  // The words longer than the model can fit are never loaded
+  int max_length = MAX_WORD_LENGTH;
+
+  grid_t* model = model_load(args.model);
+
+  if(model)
+  {
+    max_length = model_word_length_get(model);
+
+    grid_free(&model);
+  }
+
+  info_print("Creating word base of words up to %d letters", max_length);
+
+  wbase_t* wbase = wbase_create(args.wfiles, args.wfile_count, max_length);
 
   if(!wbase)
   {
@@ -440,6 +687,8 @@ int main(int argc, char* argv[])
     debug_file_close();
 
     free(args.wfiles);
+    free(args.refills);
+    free(args.locks);
 
     return 2;
   }
@@ -452,12 +701,21 @@ int main(int argc, char* argv[])
 
   stats_init();
 
+  if(args.stream && best_grid_stream_open(args.stream_file) != 0)
+  {
+    error_print("Failed to open stream: %s", args.stream_file);
+  }
+
   is_running = true;
 
   if(args.interact)
   {
     interact_routine(wbase);
   }
+  else if(args.repair || args.refill_count > 0)
+  {
+    repair_routine(wbase);
+  }
   else
   {
     gen_routine(wbase);
@@ -465,6 +723,8 @@ int main(int argc, char* argv[])
 
   is_running = false;
 
+  best_grid_stream_close();
+
   curr_grid_free();
   best_grid_free();
   
@@ -479,6 +739,8 @@ int main(int argc, char* argv[])
   debug_file_close();
 
   free(args.wfiles);
+  free(args.refills);
+  free(args.locks);
 
   return 0;
 }
@@ -0,0 +1,125 @@
+/*
+ * k-grid-test.c - test the used words of copied grids
+ *
+ * The used words and their words_hash have to agree after a copy,
+ * since the remembered queries of a word base are keyed on the hash
+ */
+
+#include "k-grid.h"
+#include "k-grid-intern.h"
+
+// The definitions are otherwise in korsord.c
+#define DEBUG_IMPLEMENT
+#include "debug.h"
+
+#define FILE_IMPLEMENT
+#include "file.h"
+
+/*
+ * Check that grid uses exactly words, and that the hash agrees
+ *
+ * Unusing every word has to empty both the trie and the hash
+ *
+ * RETURN (bool is_correct)
+ */
+static bool grid_words_check(grid_t* grid, const char** words, size_t count)
+{
+  if(trie_word_count(grid->words) != count) return false;
+
+  for(size_t index = 0; index < count; index++)
+  {
+    if(!trie_word_exists(grid->words, words[index])) return false;
+  }
+
+  grid_t* dup = grid_dup(grid);
+
+  if(!dup) return false;
+
+  for(size_t index = 0; index < count; index++)
+  {
+    grid_word_unuse(dup, words[index]);
+  }
+
+  bool is_correct = (trie_word_count(dup->words) == 0 && dup->words_hash == 0);
+
+  grid_free(&dup);
+
+  return is_correct;
+}
+
+/*
+ * Copy a grid with more_words onto a grid with less_words
+ *
+ * RETURN (bool is_correct)
+ */
+static bool grid_copy_test(const char** more_words, size_t more_count, const char** less_words, size_t less_count)
+{
+  grid_t* more = grid_create(4, 4);
+  grid_t* less = grid_create(4, 4);
+
+  if(!more || !less)
+  {
+    grid_free(&more);
+    grid_free(&less);
+
+    return false;
+  }
+
+  for(size_t index = 0; index < more_count; index++)
+  {
+    grid_word_use(more, more_words[index]);
+  }
+
+  for(size_t index = 0; index < less_count; index++)
+  {
+    grid_word_use(less, less_words[index]);
+  }
+
+  grid_copy(less, more);
+
+  bool is_correct = grid_words_check(less, more_words, more_count);
+
+  grid_free(&more);
+  grid_free(&less);
+
+  return is_correct;
+}
+
+int main(void)
+{
+  int fail_count = 0;
+
+  // The copy has none, some or other words than the grid
+  const char* more_words[] = { "hus", "bil", "ost", "husbil" };
+
+  const char* some_words[]  = { "bil" };
+  const char* other_words[] = { "hat", "bo" };
+
+  if(!grid_copy_test(more_words, 4, NULL, 0))
+  {
+    fprintf(stderr, "Failed to copy used words onto no used words\n");
+    fail_count++;
+  }
+
+  if(!grid_copy_test(more_words, 4, some_words, 1))
+  {
+    fprintf(stderr, "Failed to copy used words onto fewer used words\n");
+    fail_count++;
+  }
+
+  if(!grid_copy_test(more_words, 4, other_words, 2))
+  {
+    fprintf(stderr, "Failed to copy used words onto other used words\n");
+    fail_count++;
+  }
+
+  if(!grid_copy_test(some_words, 1, more_words, 4))
+  {
+    fprintf(stderr, "Failed to copy used words onto more used words\n");
+    fail_count++;
+  }
+
+  printf("k-grid-test: %d failed\n", fail_count);
+
+  return (fail_count > 0) ? 1 : 0;
+}